@@ -0,0 +1,70 @@
+#!/bin/bash
+
+# Reconfiguration and checkpoint benchmark sweep
+# Usage: ./scripts/bench.sh [extra options passed to ./test]
+#
+# Runs ./test once per combination of the lists below (space separated,
+# override them from the environment) and appends one CSV row per
+# reconfiguration to $OUT/raw.csv, then summarizes it with bench_report.sh.
+#
+#   COUNTERS  global counter counts           (default "1M 10M")
+#   RANKS     initial rank counts             (default "4 8")
+#   STEPS     expand/shrink steps             (default "2")
+#   MODES     checkpoint modes                (default every mode)
+#   REPS      repetitions of each combination (default 3)
+#   OUT       output directory                (default bench/<date>)
+#   CKPT_DIR  checkpoint directory            (default checkpoints/)
+#   LAUNCHER  command starting the ranks, followed by "-np N" (default mpirun)
+
+COUNTERS=${COUNTERS:-"1M 10M"}
+RANKS=${RANKS:-"4 8"}
+STEPS=${STEPS:-"2"}
+MODES=${MODES:-"text mpiio binary memory delta node compressed"}
+REPS=${REPS:-3}
+OUT=${OUT:-bench/$(date '+%Y%m%d-%H%M%S')}
+CKPT_DIR=${CKPT_DIR:-checkpoints/}
+LAUNCHER=${LAUNCHER:-mpirun}
+
+SCRIPT_DIR=$(cd "$(dirname "$0")" && pwd)
+
+mkdir -p "$OUT" "$CKPT_DIR"
+RAW="$OUT/raw.csv"
+
+# Record what was measured next to the numbers
+{
+    echo "date: $(date '+%Y-%m-%d %H:%M:%S')"
+    echo "host: $(hostname)"
+    echo "commit: $(git -C "$SCRIPT_DIR" rev-parse --short HEAD 2>/dev/null)"
+    echo "job: ${SLURM_JOB_ID:-none} nodes: ${SLURM_JOB_NODELIST:-local}"
+    echo "counters: $COUNTERS ranks: $RANKS steps: $STEPS modes: $MODES reps: $REPS"
+    echo "launcher: $LAUNCHER extra: $*"
+} > "$OUT/meta.txt"
+
+runs=0
+failed=0
+for counters in $COUNTERS; do
+    for ranks in $RANKS; do
+        for step in $STEPS; do
+            for mode in $MODES; do
+                for rep in $(seq 1 "$REPS"); do
+                    # Every run starts from an empty checkpoint directory
+                    rm -f "${CKPT_DIR}"counters*
+                    echo "counters=$counters ranks=$ranks step=$step mode=$mode rep=$rep"
+                    $LAUNCHER -np "$ranks" ./test --compute-time=0 --verbosity=0 --counters="$counters" \
+                        --resize-step="$step" --checkpoint-mode="$mode" --checkpoint-dir="$CKPT_DIR" \
+                        --bench="$RAW" "$@" > "$OUT/run-$counters-$ranks-$step-$mode-$rep.log" 2>&1
+                    if [ $? -ne 0 ]; then
+                        echo "  failed, see $OUT/run-$counters-$ranks-$step-$mode-$rep.log"
+                        failed=$((failed + 1))
+                    fi
+                    runs=$((runs + 1))
+                done
+            done
+        done
+    done
+done
+rm -f "${CKPT_DIR}"counters*
+
+echo "$runs runs, $failed failed, samples in $RAW"
+"$SCRIPT_DIR/bench_report.sh" "$RAW" "$OUT"
+[ $failed -eq 0 ]
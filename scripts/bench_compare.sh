@@ -0,0 +1,35 @@
+#!/bin/bash
+
+# Regression check between two benchmark summaries
+# Usage: ./scripts/bench_compare.sh baseline/summary.csv current/summary.csv [threshold_percent]
+#
+# Compares the p50 of every group and metric present in both summaries. Times
+# regress when they grow, bandwidth when it drops, by more than the threshold
+# (default 10%). Exits with status 1 if any metric regressed.
+
+BASE=$1
+CURRENT=$2
+THRESHOLD=${3:-10}
+
+if [ ! -f "$BASE" ] || [ ! -f "$CURRENT" ]; then
+    echo "Usage: $0 baseline/summary.csv current/summary.csv [threshold_percent]" >&2
+    exit 1
+fi
+
+awk -F, -v threshold="$THRESHOLD" '
+FNR == 1 { next }
+NR == FNR { base[$1 "," $2 "," $3 "," $4 "," $5 "," $6 "," $7] = $10; next }
+{
+    key = $1 "," $2 "," $3 "," $4 "," $5 "," $6 "," $7
+    if (!(key in base) || base[key] <= 0) next
+    change = ($10 - base[key]) / base[key] * 100
+    worse = $7 == "checkpoint_gbps" ? -change : change
+    status = worse > threshold ? "REGRESSION" : "ok"
+    if (worse > threshold) regressions++
+    compared++
+    printf "%-60s %12.6f %12.6f %+8.1f%% %s\n", key, base[key], $10, change, status
+}
+END {
+    printf "%d metrics compared, %d regressed by more than %s%%\n", compared, regressions, threshold
+    exit regressions > 0
+}' "$BASE" "$CURRENT"
@@ -0,0 +1,60 @@
+#!/bin/bash
+
+# Percentiles of the benchmark rows written by ./test --bench
+# Usage: ./scripts/bench_report.sh raw.csv [output_dir]
+#
+# Groups the rows by mode, codec, counters, threads and ranks before/after the
+# reconfiguration, and writes min, p50, p90, p99, max and mean of the
+# checkpoint, restart and reconfiguration times and of the checkpoint
+# bandwidth to summary.csv and summary.json (nearest-rank percentiles).
+
+RAW=$1
+OUT=${2:-$(dirname "$RAW")}
+
+if [ -z "$RAW" ] || [ ! -f "$RAW" ]; then
+    echo "Usage: $0 raw.csv [output_dir]" >&2
+    exit 1
+fi
+
+# One line per group and metric: key, metric, then its samples in ascending order
+samples() {
+    awk -F, 'NR > 1 {
+        key = $2 "," $3 "," $4 "," $5 "," $6 "," $7
+        print key ",checkpoint_s," $8
+        print key ",restart_s," $9
+        print key ",reconfig_s," $10
+        print key ",checkpoint_gbps," $12
+    }' "$RAW" | sort -t, -k1,7 -k8,8g
+}
+
+samples | awk -F, -v csv="$OUT/summary.csv" -v json="$OUT/summary.json" '
+function rank_of(p) { r = int((p * n + 99) / 100); return r < 1 ? 1 : r }
+function emit() {
+    if (n == 0) return
+    split(group, k, ",")
+    p50 = v[rank_of(50)]; p90 = v[rank_of(90)]; p99 = v[rank_of(99)]
+    printf "%s,%s,%d,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g\n", group, metric, n, v[1], p50, p90, p99, v[n], sum / n > csv
+    printf "%s  {\"mode\":\"%s\",\"codec\":\"%s\",\"counters\":%s,\"threads\":%s,\"ranks_before\":%s,\"ranks_after\":%s," \
+           "\"metric\":\"%s\",\"count\":%d,\"min\":%.9g,\"p50\":%.9g,\"p90\":%.9g,\"p99\":%.9g,\"max\":%.9g,\"mean\":%.9g}", \
+           entries++ ? ",\n" : "", k[1], k[2], k[3], k[4], k[5], k[6], metric, n, v[1], p50, p90, p99, v[n], sum / n > json
+    printf "%-10s %-5s %11s %3s %4s->%-4s %-15s %5d %12.6f %12.6f %12.6f\n", k[1], k[2], k[3], k[4], k[5], k[6], metric, n, p50, p90, p99
+}
+BEGIN {
+    print "mode,codec,counters,threads,ranks_before,ranks_after,metric,count,min,p50,p90,p99,max,mean" > csv
+    print "[" > json
+    printf "%-10s %-5s %11s %3s %10s %-15s %5s %12s %12s %12s\n", "mode", "codec", "counters", "thr", "ranks", "metric", "n", "p50", "p90", "p99"
+}
+{
+    g = $1 "," $2 "," $3 "," $4 "," $5 "," $6
+    if (g != group || $7 != metric) {
+        emit()
+        group = g; metric = $7; n = 0; sum = 0
+    }
+    v[++n] = $8; sum += $8
+}
+END {
+    emit()
+    print "\n]" > json
+}'
+
+echo "Summary written to $OUT/summary.csv and $OUT/summary.json"
@@ -1,7 +1,8 @@
 #!/bin/bash
 
 # Enhanced SLURM job monitoring script for user mderosso
-# Usage: ./monitor.sh [refresh_interval]
+# Usage: ./monitor.sh [refresh_interval] [metrics_file]
+# The metrics file is the one passed to the application with --metrics (defaults to $DMR_METRICS)
 
 # Color definitions
 RED='\033[0;31m'
@@ -17,6 +18,7 @@ NC='\033[0m' # No Color
 # Configuration
 USER="mderosso"
 REFRESH_INTERVAL=${1:-5}  # Default 5 seconds, can be overridden by command line argument
+METRICS_FILE=${2:-$DMR_METRICS}  # Live metrics snapshot written by rank 0, empty hides the view
 
 # Function to display header
 show_header() {
@@ -108,6 +110,70 @@ show_partition_info() {
     echo ""
 }
 
+# Function to show the live metrics published by rank 0 (src/metrics.h)
+show_app_metrics() {
+    [ -z "$METRICS_FILE" ] && return
+
+    echo -e "${BOLD}${GREEN}Application Metrics:${NC} ${DIM}$METRICS_FILE${NC}"
+    echo -e "${DIM}────────────────────────────────────────────────────────────────────────────────${NC}"
+
+    if [ ! -r "$METRICS_FILE" ]; then
+        echo -e "${YELLOW}No metrics yet${NC}"
+        echo ""
+        return
+    fi
+
+    # A snapshot read while rank 0 rewrites it has an odd generation, or another one after "end": read it again
+    local -A m
+    local attempt complete=0
+    for attempt in 1 2 3; do
+        m=()
+        while read -r key value; do
+            [ -n "$key" ] && m[$key]="$value"
+        done < "$METRICS_FILE"
+        if [[ "${m[generation]}" =~ [02468]$ ]] && [ "${m[generation]}" = "${m[end]}" ]; then
+            complete=1
+            break
+        fi
+        sleep 0.1
+    done
+    if [ "$complete" != "1" ]; then
+        echo -e "${YELLOW}Snapshot incomplete, retrying at the next refresh${NC}"
+        echo ""
+        return
+    fi
+
+    # No snapshot for three intervals while running means the application is stuck
+    local age=$(awk -v now="$(date +%s.%N)" -v then="${m[updated]}" 'BEGIN { printf "%.1f", now - then }')
+    local state_color=$GREEN
+    local state="${m[state]}"
+    if [ "$state" = "finished" ]; then
+        state_color=$BLUE
+    elif awk -v age="$age" -v interval="${m[interval]}" 'BEGIN { exit !(age > 3 * interval && age > 3) }'; then
+        state="$state, STALLED"
+        state_color=$RED
+    elif [ "$state" != "running" ]; then
+        state_color=$YELLOW
+    fi
+
+    local moved_mb=$(awk -v bytes="${m[moved_bytes]}" 'BEGIN { printf "%.1f", bytes / 1048576 }')
+    local resize="none yet"
+    read -r from to <<< "${m[last_resize]}"
+    [ "$from" != "0" ] && resize="$from -> $to ranks, ${moved_mb} MB moved"
+
+    echo -e "  ${CYAN}State:${NC} ${state_color}${state}${NC} ${DIM}(updated ${age}s ago, pid ${m[pid]})${NC}"
+    echo -e "  ${CYAN}Iteration:${NC} ${m[iteration]} at ${GREEN}${m[iterations_per_second]}${NC} it/s"
+    echo -e "  ${CYAN}Processes:${NC} ${m[ranks]} ranks x ${m[threads]} threads"
+    # The application only counts the increments left under --policy=cost
+    local left=""
+    [ "${m[remaining]}" != "-1" ] && left=" ${DIM}(${m[remaining]} increments left)${NC}"
+    echo -e "  ${CYAN}Live counters:${NC} ${m[live_counters]}${left}"
+    echo -e "  ${CYAN}Last checkpoint:${NC} ${m[checkpoint_seconds]} s  ${CYAN}Last restart:${NC} ${m[restart_seconds]} s"
+    echo -e "  ${CYAN}Reconfigurations:${NC} ${m[reconfigurations]}, last took ${m[reconfig_seconds]} s"
+    echo -e "  ${CYAN}Last resize:${NC} $resize"
+    echo ""
+}
+
 # Function to handle script termination
 cleanup() {
     echo -e "\n${YELLOW}Monitoring stopped.${NC}"
@@ -121,6 +187,7 @@ trap cleanup SIGINT
 echo -e "${BOLD}${GREEN}Starting SLURM job monitoring for user ${CYAN}$USER${NC}"
 echo -e "${DIM}Press Ctrl+C to stop monitoring${NC}"
 echo -e "${DIM}Refresh interval: ${REFRESH_INTERVAL} seconds${NC}"
+[ -n "$METRICS_FILE" ] && echo -e "${DIM}Application metrics: ${METRICS_FILE}${NC}"
 echo ""
 
 while true; do
@@ -129,6 +196,7 @@ while true; do
     show_header
     get_job_stats
     show_detailed_jobs
+    show_app_metrics
     show_resource_summary
     show_recent_history
     show_partition_info
@@ -0,0 +1,46 @@
+/**
+ * @file active_set.c
+ * @brief Implementation of the live counter list.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "active_set.h"
+
+void active_set_build(ActiveSet *set, const counter_t *counters, int64_t num_counters, int max_value)
+{
+    if (num_counters > set->capacity)
+    {
+        free(set->live);
+        set->live = malloc(num_counters * sizeof(int));
+        if (!set->live)
+        {
+            fprintf(stderr, "Memory allocation failed for %lld live counters\n", (long long)num_counters);
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        set->capacity = num_counters;
+    }
+
+    set->count = 0;
+    for (int64_t i = 0; i < num_counters; i++)
+    {
+        if (counters[i] < max_value)
+        {
+            set->live[set->count++] = (int)i;
+        }
+    }
+}
+
+void active_set_free(ActiveSet *set)
+{
+    free(set->live);
+    set->live = NULL;
+    set->count = 0;
+    set->capacity = 0;
+}
@@ -0,0 +1,51 @@
+/**
+ * @file active_set.h
+ * @brief Compacted list of the local counters that have not finished yet.
+ *
+ * The main loop walks the live indices instead of the whole slice, so finished
+ * counters are neither visited nor passed to compute(), and the termination test
+ * is a comparison of the live count with zero. The list keeps the counters in
+ * ascending order and is compacted in place as counters finish.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef ACTIVE_SET_H
+#define ACTIVE_SET_H
+
+#include <stdint.h>
+
+#include "counter.h"
+
+/**
+ * @brief Live counters of the local slice.
+ */
+typedef struct
+{
+    int *live;        /**< Local indices of the unfinished counters, ascending */
+    int64_t count;    /**< Number of unfinished counters */
+    int64_t capacity; /**< Allocated length of live */
+} ActiveSet;
+
+/**
+ * @brief Rebuilds the set from the current counter values.
+ *
+ * @param set Set to rebuild; its storage is reused or grown as needed
+ * @param counters Pointer to the local counters array
+ * @param num_counters Number of counters in the local array (at most INT_MAX)
+ * @param max_value Value at which a counter is considered finished
+ *
+ * @note Aborts on memory allocation failure
+ */
+void active_set_build(ActiveSet *set, const counter_t *counters, int64_t num_counters, int max_value);
+
+/**
+ * @brief Releases the storage of the set.
+ *
+ * @param set Set to release; left empty and reusable
+ */
+void active_set_free(ActiveSet *set);
+
+#endif /* ACTIVE_SET_H */
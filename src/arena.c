@@ -0,0 +1,162 @@
+/**
+ * @file arena.c
+ * @brief Implementation of the reusable buffers.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <limits.h>
+#include <mpi.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "arena.h"
+
+/** @brief One mapping and whether a caller holds it */
+typedef struct
+{
+    void *base;
+    size_t capacity;
+    int used;
+} ArenaSlot;
+
+/** @brief State of the arena of this process */
+static struct
+{
+    int huge_pages;
+    size_t page;
+    size_t reserve;
+    ArenaSlot slots[ARENA_SLOTS];
+} arena;
+
+/**
+ * @brief Rounds a size up to a multiple of the page size in use.
+ */
+static size_t round_up(size_t bytes, size_t page)
+{
+    return (bytes + page - 1) / page * page;
+}
+
+/**
+ * @brief Maps a slot able to hold bytes.
+ */
+static void map_slot(ArenaSlot *slot, size_t bytes)
+{
+    // hugetlbfs pages first, if the system reserved any for the request
+    if (arena.huge_pages)
+    {
+        size_t length = round_up(bytes, ARENA_HUGE_PAGE);
+        void *base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (base != MAP_FAILED)
+        {
+            slot->base = base;
+            slot->capacity = length;
+            return;
+        }
+    }
+
+    // Room for the largest slice, unless the system refuses to overcommit it
+    size_t length = round_up(bytes > arena.reserve ? bytes : arena.reserve, arena.page);
+    void *base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED)
+    {
+        length = round_up(bytes, arena.page);
+        base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+    if (base == MAP_FAILED)
+    {
+        fprintf(stderr, "Could not map %zu bytes for the arena\n", bytes);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+#ifdef MADV_HUGEPAGE
+    if (arena.huge_pages)
+    {
+        madvise(base, length, MADV_HUGEPAGE);
+    }
+#endif
+    slot->base = base;
+    slot->capacity = length;
+}
+
+void arena_init(const Config *cfg)
+{
+    arena.huge_pages = cfg->huge_pages;
+    arena.page = arena.huge_pages ? ARENA_HUGE_PAGE : (size_t)sysconf(_SC_PAGESIZE);
+
+    // No rank ever holds more than every counter, nor more than init_counters() accepts
+    int64_t largest = cfg->num_counters < INT_MAX ? cfg->num_counters : INT_MAX;
+    arena.reserve = round_up((size_t)largest * sizeof(int32_t), arena.page);
+}
+
+void *arena_acquire(size_t bytes)
+{
+    // The smallest free buffer that fits, the largest free one to grow otherwise
+    ArenaSlot *fit = NULL, *grow = NULL, *empty = NULL;
+    for (int s = 0; s < ARENA_SLOTS; s++)
+    {
+        ArenaSlot *slot = &arena.slots[s];
+        if (slot->used)
+        {
+            continue;
+        }
+        if (!slot->base)
+        {
+            empty = empty ? empty : slot;
+        }
+        else if (slot->capacity >= bytes)
+        {
+            fit = !fit || slot->capacity < fit->capacity ? slot : fit;
+        }
+        else
+        {
+            grow = !grow || slot->capacity > grow->capacity ? slot : grow;
+        }
+    }
+
+    ArenaSlot *slot = fit;
+    if (!slot)
+    {
+        slot = empty ? empty : grow;
+        if (!slot)
+        {
+            fprintf(stderr, "Arena exhausted: all %d buffers are in use\n", ARENA_SLOTS);
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        if (slot->base)
+        {
+            munmap(slot->base, slot->capacity);
+        }
+        map_slot(slot, bytes);
+    }
+    slot->used = 1;
+    return slot->base;
+}
+
+void arena_release(void *buffer)
+{
+    for (int s = 0; buffer && s < ARENA_SLOTS; s++)
+    {
+        if (arena.slots[s].base == buffer)
+        {
+            arena.slots[s].used = 0;
+            return;
+        }
+    }
+}
+
+void arena_close(void)
+{
+    for (int s = 0; s < ARENA_SLOTS; s++)
+    {
+        if (arena.slots[s].base)
+        {
+            munmap(arena.slots[s].base, arena.slots[s].capacity);
+        }
+        arena.slots[s] = (ArenaSlot){NULL, 0, 0};
+    }
+}
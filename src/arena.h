@@ -0,0 +1,76 @@
+/**
+ * @file arena.h
+ * @brief Reusable page-backed buffers for the counters and checkpoint staging.
+ *
+ * Every reconfiguration used to free the counters array and allocate the new
+ * one, so each restart faulted in fresh pages. The arena keeps a few anonymous
+ * mappings for the lifetime of the process instead: arena_release() marks a
+ * buffer free without unmapping it, and the next arena_acquire() of a size it
+ * can hold returns it with its pages already faulted in. Buffers are page
+ * aligned, hence 64-byte (cache line) aligned.
+ *
+ * Each mapping reserves address space for the largest slice a rank can get
+ * (every counter, capped at INT_MAX as init_counters() is), with
+ * MAP_NORESERVE, so a shrink that grows the slice reuses the same buffer. Only
+ * the pages that are touched take memory.
+ *
+ * With --huge-pages=1, buffers come from 2 MB huge pages: hugetlbfs pages
+ * (MAP_HUGETLB) if the system has some reserved, transparent huge pages
+ * (MADV_HUGEPAGE) otherwise. hugetlbfs mappings reserve their pages up front,
+ * so they are sized to the request rather than to the largest slice.
+ *
+ * The caller places the pages on NUMA nodes by touching them first from the
+ * threads that will use them (see init_counters()).
+ *
+ * @note Main thread only
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#include "config.h"
+
+/** @brief Buffers the arena can hold at the same time */
+#define ARENA_SLOTS 8
+
+/** @brief Size of a huge page */
+#define ARENA_HUGE_PAGE (2u << 20)
+
+/**
+ * @brief Sets the page size and the address space reserved per buffer.
+ *
+ * @param cfg Runtime configuration (huge_pages, num_counters)
+ */
+void arena_init(const Config *cfg);
+
+/**
+ * @brief Returns a buffer of at least bytes, reusing a released one if possible.
+ *
+ * @param bytes Size of the buffer, positive
+ * @return Page-aligned buffer; its content is undefined
+ *
+ * @note Aborts if the mapping fails or every slot is in use
+ */
+void *arena_acquire(size_t bytes);
+
+/**
+ * @brief Gives a buffer back to the arena, which keeps it mapped for later acquires.
+ *
+ * @param buffer Buffer returned by arena_acquire(), or NULL
+ */
+void arena_release(void *buffer);
+
+/**
+ * @brief Unmaps every buffer.
+ *
+ * @note No buffer may be used afterwards
+ */
+void arena_close(void);
+
+#endif /* ARENA_H */
@@ -0,0 +1,201 @@
+/**
+ * @file async_checkpoint.c
+ * @brief Implementation of asynchronous, double-buffered checkpoints.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include "test.h"
+#include "async_checkpoint.h"
+#include "delta_checkpoint.h"
+#include "node_tier.h"
+#include "checkpoint_commit.h"
+#include "buddy.h"
+
+/** @brief Request slots of one asynchronous checkpoint */
+enum
+{
+    REQ_DATA = 0, /**< Nonblocking write of the local snapshot */
+    REQ_CRC,      /**< Nonblocking write of the snapshot's CRCs */
+    REQ_SUM,      /**< Nonblocking reduction of the checksum to rank 0 */
+    REQ_HEADER,   /**< Nonblocking write of the header (rank 0 only) */
+    REQ_COUNT
+};
+
+/** @brief State of the checkpoint in flight and its snapshot buffer */
+static struct
+{
+    int in_flight;
+    int rank;
+    int size;
+    MPI_Comm comm;
+    const Config *cfg;
+    MPI_File fh;
+    int32_t *snapshot;
+    int64_t capacity;
+    uint32_t *crcs;
+    uint64_t crc_capacity;
+    int64_t num_counters;
+    uint64_t epoch;
+    uint64_t local_sum;
+    uint64_t global_sum;
+    CheckpointHeader header;
+    int header_started;
+    MPI_Request requests[REQ_COUNT];
+} async = {0};
+
+/**
+ * @brief Starts the header write on rank 0 once the checksum is known.
+ */
+static void start_header(void)
+{
+    ckpt_header_init(&async.header, async.num_counters, async.size, async.epoch, async.global_sum);
+    if (MPI_File_iwrite_at(async.fh, 0, &async.header, sizeof(async.header), MPI_BYTE, &async.requests[REQ_HEADER]) != MPI_SUCCESS)
+    {
+        fprintf(stderr, "Failed to start checkpoint header write on rank %d\n", async.rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    async.header_started = 1;
+}
+
+void checkpoint_async_begin(int rank, int size, const counter_t *counters, int64_t num_counters, const Config *cfg)
+{
+    // Only one checkpoint in flight: the snapshot buffer is reused
+    checkpoint_async_wait();
+
+    if (num_counters > async.capacity)
+    {
+        free(async.snapshot);
+        async.snapshot = malloc(num_counters * sizeof(int32_t));
+        if (!async.snapshot)
+        {
+            fprintf(stderr, "Memory allocation failed on rank %d\n", rank);
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        async.capacity = num_counters;
+    }
+
+    // Snapshot, in the int32 values of the file: from here on the live counters can change freely
+    counter_widen(async.snapshot, counters, num_counters);
+
+    MPI_Comm comm = buddy_world_comm();
+
+    // A node drain stages the same file: it must be committed before this snapshot is staged
+    if (cfg->ckpt_mode == CKPT_MODE_NODE)
+    {
+        node_tier_settle(comm, cfg);
+    }
+
+    // The CRCs are computed from the snapshot, so they match what is written
+    uint64_t num_crcs = ckpt_crc_count(num_counters);
+    if (num_crcs > async.crc_capacity)
+    {
+        free(async.crcs);
+        async.crcs = malloc(num_crcs * sizeof(uint32_t));
+        if (!async.crcs)
+        {
+            fprintf(stderr, "Memory allocation failed on rank %d\n", rank);
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        async.crc_capacity = num_crcs;
+    }
+    ckpt_crc_slice(async.snapshot, num_counters, async.crcs);
+
+    char staged[CKPT_PATH_SIZE];
+    checkpoint_staged_path(staged, sizeof(staged), cfg);
+    if (MPI_File_open(comm, staged, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &async.fh) != MPI_SUCCESS)
+    {
+        fprintf(stderr, "Could not open file %s with MPI-IO on rank %d\n", staged, rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    MPI_File_set_size(async.fh, ckpt_crc_position(cfg->num_counters, size, size));
+
+    async.rank = rank;
+    async.size = size;
+    async.comm = comm;
+    async.cfg = cfg;
+    async.num_counters = cfg->num_counters;
+    async.epoch = checkpoint_next_epoch();
+
+    // The snapshot is a full base: later deltas only need changes made after it
+    delta_rebase(async.epoch);
+
+    async.header_started = 0;
+    for (int i = 0; i < REQ_COUNT; i++)
+    {
+        async.requests[i] = MPI_REQUEST_NULL;
+    }
+
+    int64_t first = offset(rank, size, cfg->num_counters);
+    async.local_sum = ckpt_checksum(async.snapshot, first, num_counters);
+    MPI_Ireduce(&async.local_sum, &async.global_sum, 1, MPI_UINT64_T, MPI_SUM, 0, comm, &async.requests[REQ_SUM]);
+
+    // The CRCs go to the place of the block of the slice in the table
+    MPI_Offset position = CKPT_HEADER_SIZE + (MPI_Offset)first * sizeof(int32_t);
+    MPI_Offset crc_position = ckpt_crc_position(cfg->num_counters, size, slice_block(rank, size, cfg->num_counters));
+    if (MPI_File_iwrite_at(async.fh, position, async.snapshot, (int)num_counters, MPI_INT32_T, &async.requests[REQ_DATA]) != MPI_SUCCESS ||
+        MPI_File_iwrite_at(async.fh, crc_position, async.crcs, (int)num_crcs,
+                           MPI_UINT32_T, &async.requests[REQ_CRC]) != MPI_SUCCESS)
+    {
+        fprintf(stderr, "Failed to start checkpoint write on rank %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    async.in_flight = 1;
+}
+
+void checkpoint_async_progress(void)
+{
+    if (!async.in_flight)
+    {
+        return;
+    }
+
+    int done;
+    MPI_Test(&async.requests[REQ_SUM], &done, MPI_STATUS_IGNORE);
+    if (done && async.rank == 0 && !async.header_started)
+    {
+        start_header();
+    }
+    MPI_Test(&async.requests[REQ_DATA], &done, MPI_STATUS_IGNORE);
+    MPI_Test(&async.requests[REQ_CRC], &done, MPI_STATUS_IGNORE);
+    MPI_Test(&async.requests[REQ_HEADER], &done, MPI_STATUS_IGNORE);
+}
+
+void checkpoint_async_wait(void)
+{
+    if (!async.in_flight)
+    {
+        return;
+    }
+
+    // The header can only be written once the checksum reduction has completed
+    MPI_Wait(&async.requests[REQ_SUM], MPI_STATUS_IGNORE);
+    if (async.rank == 0 && !async.header_started)
+    {
+        start_header();
+    }
+    MPI_Waitall(REQ_COUNT, async.requests, MPI_STATUSES_IGNORE);
+
+    MPI_File_sync(async.fh);
+    MPI_File_close(&async.fh);
+    async.in_flight = 0;
+    checkpoint_commit(async.comm, async.rank, async.cfg);
+}
+
+void checkpoint_async_abandon(void)
+{
+    if (!async.in_flight)
+    {
+        return;
+    }
+
+    // The writes are independent and complete locally; the reduction and the collective close
+    // would synchronize with the failed rank, so they are left behind with the file handle
+    MPI_Wait(&async.requests[REQ_DATA], MPI_STATUS_IGNORE);
+    MPI_Wait(&async.requests[REQ_CRC], MPI_STATUS_IGNORE);
+    MPI_Wait(&async.requests[REQ_HEADER], MPI_STATUS_IGNORE);
+    async.in_flight = 0;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file async_checkpoint.h
+ * @brief Asynchronous, double-buffered fault-tolerance checkpoints.
+ *
+ * checkpoint_async_begin() copies the local counters into a private snapshot
+ * buffer and starts nonblocking MPI-IO writes of that snapshot into the global
+ * checkpoint file (binary format, see checkpoint_format.h). Control returns to
+ * the caller right away, so the increment/compute loop keeps running while the
+ * data is written. checkpoint_async_progress() drives the outstanding requests
+ * and checkpoint_async_wait() is the completion fence. The data goes to the
+ * staged file, which the fence commits (see checkpoint_commit.h), so the
+ * previous checkpoint stays intact until the new one is complete.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef ASYNC_CHECKPOINT_H
+#define ASYNC_CHECKPOINT_H
+
+#include <stdint.h>
+
+#include "config.h"
+#include "counter.h"
+
+/**
+ * @brief Starts an asynchronous checkpoint of the local counters.
+ *
+ * Any checkpoint still in flight is completed first. The counters are copied into
+ * the snapshot buffer, so the caller may modify them as soon as this returns.
+ *
+ * @param rank Current MPI rank
+ * @param size Total number of MPI ranks
+ * @param counters Pointer to the local counters array
+ * @param num_counters Number of counters in the local array
+ * @param cfg Runtime configuration (checkpoint path and global counter count)
+ *
+ * @note Collective over buddy_world_comm() (file open and size are collective)
+ */
+void checkpoint_async_begin(int rank, int size, const counter_t *counters, int64_t num_counters, const Config *cfg);
+
+/**
+ * @brief Lets the MPI library progress the outstanding checkpoint requests.
+ *
+ * Cheap when nothing is in flight. Meant to be called once per iteration.
+ *
+ * @note Local operation, not collective
+ */
+void checkpoint_async_progress(void);
+
+/**
+ * @brief Completion fence: returns once the last asynchronous checkpoint is on disk.
+ *
+ * Must be called before anything relies on the checkpoint file, in particular
+ * before a DMR reconfiguration and before the program terminates. The staged
+ * file is synced and committed before it returns.
+ *
+ * @note Collective over the communicator of the checkpoint in flight; a no-op when
+ *       none is in flight on any rank
+ */
+void checkpoint_async_wait(void);
+
+/**
+ * @brief Drops the checkpoint in flight on a communicator that lost a process.
+ *
+ * The staged file is left uncommitted, so the committed checkpoint stays the
+ * last complete one. Its writes are completed, as a pending write on the
+ * stale handle can block later file operations. Used by recover() before the
+ * communicator is replaced.
+ *
+ * @note Local operation, not collective
+ */
+void checkpoint_async_abandon(void);
+
+#endif /* ASYNC_CHECKPOINT_H */
@@ -0,0 +1,109 @@
+/**
+ * @file bench.c
+ * @brief Implementation of the benchmark records.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "bench.h"
+#include "hybrid.h"
+
+/** @brief Columns of every benchmark row, in order */
+#define BENCH_HEADER "timestamp,mode,codec,counters,threads,ranks_before,ranks_after," \
+                     "checkpoint_s,restart_s,reconfig_s,state_bytes,checkpoint_gbps\n"
+
+/** @brief State of the benchmark records of this process */
+static struct
+{
+    int enabled;
+    FILE *file;
+    const Config *cfg;
+    double started[BENCH_PHASE_COUNT];
+    double seconds[BENCH_PHASE_COUNT];
+    int recorded[BENCH_PHASE_COUNT];
+} bench;
+
+void bench_init(int rank, const Config *cfg)
+{
+    bench.enabled = cfg->bench_path[0] != '\0';
+    bench.cfg = cfg;
+    if (!bench.enabled || rank != 0)
+    {
+        return;
+    }
+
+    bench.file = fopen(cfg->bench_path, "a");
+    if (!bench.file)
+    {
+        fprintf(stderr, "Warning: Could not open benchmark file %s, no rows are written\n", cfg->bench_path);
+        return;
+    }
+    if (ftell(bench.file) == 0)
+    {
+        fputs(BENCH_HEADER, bench.file);
+    }
+}
+
+void bench_begin(BenchPhase phase)
+{
+    if (bench.enabled)
+    {
+        bench.started[phase] = MPI_Wtime();
+    }
+}
+
+void bench_end(BenchPhase phase, MPI_Comm comm)
+{
+    // Every rank of comm sees the same configuration, so they agree on skipping
+    if (!bench.enabled)
+    {
+        return;
+    }
+
+    // The phase ends when its slowest rank is done
+    double local = MPI_Wtime() - bench.started[phase];
+    MPI_Reduce(&local, &bench.seconds[phase], 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+    bench.recorded[phase] = 1;
+}
+
+void bench_reconfig(int rank, int old_size, int new_size, double seconds)
+{
+    if (!bench.enabled || rank != 0 || !bench.recorded[BENCH_CHECKPOINT])
+    {
+        return;
+    }
+
+    const Config *cfg = bench.cfg;
+    double bytes = (double)cfg->num_counters * sizeof(int32_t);
+    double checkpoint_s = bench.seconds[BENCH_CHECKPOINT];
+    double restart_s = bench.recorded[BENCH_RESTART] ? bench.seconds[BENCH_RESTART] : 0.0;
+    if (bench.file)
+    {
+        fprintf(bench.file, "%lld,%s,%s,%lld,%d,%d,%d,%.9f,%.9f,%.9f,%.0f,%.6f\n", (long long)time(NULL),
+                checkpoint_mode_name(cfg->ckpt_mode), checkpoint_codec_name(cfg->codec), (long long)cfg->num_counters,
+                hybrid_threads(), old_size, new_size, checkpoint_s, restart_s, seconds, bytes,
+                checkpoint_s > 0.0 ? bytes / checkpoint_s / 1e9 : 0.0);
+    }
+
+    // The next row only counts the phases of the next reconfiguration
+    for (int p = 0; p < BENCH_PHASE_COUNT; p++)
+    {
+        bench.recorded[p] = 0;
+    }
+}
+
+void bench_close(void)
+{
+    if (bench.file)
+    {
+        fclose(bench.file);
+        bench.file = NULL;
+    }
+    bench.enabled = 0;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file bench.h
+ * @brief Benchmark records of checkpoint bandwidth and reconfiguration latency.
+ *
+ * With a benchmark file configured, every reconfiguration appends one CSV row
+ * to it on rank 0: checkpoint mode and codec, global counter count, threads,
+ * communicator size before and after, the time of checkpoint() and restart()
+ * on the slowest rank, the time of the whole DMR_AUTO call on rank 0, the size
+ * of the counter state and the effective checkpoint bandwidth (state size over
+ * checkpoint time, whatever the mode actually writes). Runs append to the same
+ * file, so a sweep collects all of its samples in one place; the scripts in
+ * scripts/bench*.sh turn them into percentiles and compare two sweeps.
+ *
+ * Without a benchmark file every call returns right away.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <mpi.h>
+
+#include "config.h"
+
+/**
+ * @brief Phases recorded in the benchmark rows.
+ */
+typedef enum
+{
+    BENCH_CHECKPOINT = 0, /**< Whole checkpoint() callback, old communicator */
+    BENCH_RESTART,        /**< Whole restart() callback, new communicator */
+    BENCH_PHASE_COUNT
+} BenchPhase;
+
+/**
+ * @brief Enables the benchmark records if a benchmark file is configured.
+ *
+ * Rank 0 opens the file for appending and writes the CSV header if it is empty.
+ *
+ * @param rank Current MPI rank
+ * @param cfg Runtime configuration (bench_path and the parameters written in every row)
+ */
+void bench_init(int rank, const Config *cfg);
+
+/**
+ * @brief Starts timing a phase.
+ *
+ * @param phase Phase to time
+ */
+void bench_begin(BenchPhase phase);
+
+/**
+ * @brief Stops timing a phase and keeps its time on the slowest rank.
+ *
+ * @param phase Phase started by bench_begin()
+ * @param comm Communicator of the ranks running the phase
+ *
+ * @note Collective over comm when enabled: every rank of comm must call it
+ */
+void bench_end(BenchPhase phase, MPI_Comm comm);
+
+/**
+ * @brief Writes the row of a reconfiguration that ran a checkpoint.
+ *
+ * @param rank Current MPI rank; only rank 0 writes
+ * @param old_size Communicator size before the reconfiguration
+ * @param new_size Communicator size after the reconfiguration
+ * @param seconds Time of the DMR_AUTO call on this rank
+ *
+ * @note Local operation: rank 0 always survives a reconfiguration
+ */
+void bench_reconfig(int rank, int old_size, int new_size, double seconds);
+
+/**
+ * @brief Flushes and closes the benchmark file.
+ */
+void bench_close(void);
+
+#endif /* BENCH_H */
@@ -0,0 +1,304 @@
+/**
+ * @file buddy.c
+ * @brief Implementation of the buddy replicas and of the ULFM recovery.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include "test.h"
+#include "buddy.h"
+
+#if defined(__has_include)
+#if __has_include(<mpi-ext.h>)
+#include <mpi-ext.h>
+#endif
+#endif
+
+// ULFM builds define the failure error classes along with MPIX_Comm_shrink()
+#if defined(MPIX_ERR_PROC_FAILED) && defined(MPIX_ERR_REVOKED)
+#define BUDDY_ULFM 1
+#endif
+
+/** @brief Replica held for another rank and the state of the recovery */
+static struct
+{
+    int enabled;
+    volatile int failed;
+    int recovered;
+    MPI_Comm comm;            /**< Communicator of the survivors after a recovery */
+    MPI_Errhandler handler;
+    counter_t *replica;       /**< Slice of rank owner in the layout of size ranks */
+    int64_t capacity;
+    int owner;
+    int size;
+    int shift;
+} buddy = {0, 0, 0, MPI_COMM_NULL, MPI_ERRHANDLER_NULL, NULL, 0, -1, 0, 0};
+
+/**
+ * @brief Counters shared by the ranges [a, a + na) and [b, b + nb); *lo is the first of them.
+ */
+static int64_t shared(int64_t a, int64_t na, int64_t b, int64_t nb, int64_t *lo)
+{
+    *lo = a > b ? a : b;
+    int64_t hi = a + na < b + nb ? a + na : b + nb;
+    return hi > *lo ? hi - *lo : 0;
+}
+
+#ifdef BUDDY_ULFM
+/**
+ * @brief Error handler of the job communicator: failures are recorded for recover(), anything else aborts.
+ */
+static void on_error(MPI_Comm *comm, int *code, ...)
+{
+    int eclass;
+    MPI_Error_class(*code, &eclass);
+    if (eclass == MPIX_ERR_PROC_FAILED || eclass == MPIX_ERR_REVOKED
+#ifdef MPIX_ERR_PROC_FAILED_PENDING
+        || eclass == MPIX_ERR_PROC_FAILED_PENDING
+#endif
+    )
+    {
+        // Every survivor's next operation on the communicator fails too, so all of them reach recover()
+        buddy.failed = 1;
+        MPIX_Comm_revoke(*comm);
+        return;
+    }
+
+    char message[MPI_MAX_ERROR_STRING];
+    int length = 0;
+    MPI_Error_string(*code, message, &length);
+    fprintf(stderr, "MPI error: %s\n", message);
+    MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+}
+#endif
+
+void buddy_init(int rank, const Config *cfg)
+{
+    buddy.enabled = 0;
+    if (!cfg->buddy)
+    {
+        return;
+    }
+#ifdef BUDDY_ULFM
+    if (cfg->steal_chunk > 0 || cfg->ckpt_mode == CKPT_MODE_NODE)
+    {
+        if (rank == 0)
+        {
+            fprintf(stderr, "Warning: buddy recovery does not support work stealing or the node tier, --buddy=1 is ignored\n");
+        }
+        return;
+    }
+    buddy.enabled = 1;
+#else
+    if (rank == 0)
+    {
+        fprintf(stderr, "Warning: built without the ULFM extensions (MPIX_Comm_shrink), --buddy=1 is ignored\n");
+    }
+#endif
+}
+
+void buddy_mirror(MPI_Comm comm, int rank, int size, const counter_t *counters, int64_t num_counters, const Config *cfg)
+{
+    if (!buddy.enabled)
+    {
+        return;
+    }
+#ifdef BUDDY_ULFM
+    if (buddy.handler == MPI_ERRHANDLER_NULL)
+    {
+        MPI_Comm_create_errhandler(on_error, &buddy.handler);
+    }
+    MPI_Comm_set_errhandler(comm, buddy.handler);
+#endif
+
+    // One node's worth of ranks away: on another node when ranks are placed node by node
+    MPI_Comm node;
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node);
+    int node_size, shift;
+    MPI_Comm_size(node, &node_size);
+    MPI_Comm_free(&node);
+    MPI_Allreduce(&node_size, &shift, 1, MPI_INT, MPI_MAX, comm);
+    shift %= size;
+    if (shift == 0 && size > 1)
+    {
+        shift = 1;
+    }
+    buddy.size = size;
+    buddy.shift = shift;
+    if (shift == 0)
+    {
+        // A single rank has no buddy
+        buddy.owner = -1;
+        return;
+    }
+
+    int dst = (rank + shift) % size;
+    int src = (rank - shift + size) % size;
+    int64_t count = dimension(src, size, cfg->num_counters);
+    if (count > buddy.capacity)
+    {
+        free(buddy.replica);
+        buddy.replica = malloc((size_t)count * sizeof(counter_t));
+        if (!buddy.replica)
+        {
+            fprintf(stderr, "Memory allocation failed on rank %d\n", rank);
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        buddy.capacity = count;
+    }
+    MPI_Sendrecv(counters, (int)num_counters, MPI_COUNTER, dst, 0, buddy.replica, (int)count, MPI_COUNTER, src, 0, comm,
+                 MPI_STATUS_IGNORE);
+    buddy.owner = src;
+}
+
+int buddy_failed(void)
+{
+    return buddy.failed;
+}
+
+int buddy_recovered(void)
+{
+    return buddy.recovered;
+}
+
+MPI_Comm buddy_world_comm(void)
+{
+    return buddy.recovered ? buddy.comm : dmr_get_world_comm();
+}
+
+MPI_Comm buddy_shrink(int *old_size)
+{
+    MPI_Comm failed = buddy_world_comm();
+    int old_rank;
+    MPI_Comm_rank(failed, &old_rank);
+    MPI_Comm_size(failed, old_size);
+#ifdef BUDDY_ULFM
+    MPIX_Comm_revoke(failed);
+    MPI_Comm shrunk;
+    if (MPIX_Comm_shrink(failed, &shrunk) != MPI_SUCCESS)
+    {
+        fprintf(stderr, "Could not shrink the communicator after a failure on rank %d\n", old_rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    MPI_Comm_set_errhandler(shrunk, buddy.handler);
+
+    // The revoked communicator is not freed: freeing it would synchronize with the dead ranks
+    buddy.comm = shrunk;
+    buddy.recovered = 1;
+    buddy.failed = 0;
+    return shrunk;
+#else
+    fprintf(stderr, "Process failure on rank %d, but recovery needs the ULFM extensions\n", old_rank);
+    MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    return failed;
+#endif
+}
+
+int64_t buddy_rebuild(MPI_Comm comm, int old_rank, int old_size, const counter_t *counters, counter_t *dst,
+                      const Config *cfg)
+{
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    int64_t total = cfg->num_counters;
+
+    // Which old ranks survived, and under which new rank
+    int *old_ranks = malloc((size_t)size * sizeof(int));
+    int *alive = malloc((size_t)old_size * sizeof(int));
+    int *counts = calloc(4 * (size_t)size, sizeof(int));
+    if (!old_ranks || !alive || !counts)
+    {
+        fprintf(stderr, "Memory allocation failed on rank %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    MPI_Allgather(&old_rank, 1, MPI_INT, old_ranks, 1, MPI_INT, comm);
+    for (int r = 0; r < old_size; r++)
+    {
+        alive[r] = -1;
+    }
+    for (int s = 0; s < size; s++)
+    {
+        alive[old_ranks[s]] = s;
+    }
+
+    // Every survivor must have mirrored the layout that failed
+    int valid = buddy.size == old_size && buddy.shift > 0, all_valid;
+    MPI_Allreduce(&valid, &all_valid, 1, MPI_INT, MPI_MIN, comm);
+    int64_t from_replicas = 0;
+    for (int r = 0; r < old_size; r++)
+    {
+        if (alive[r] >= 0)
+        {
+            continue;
+        }
+        if (!all_valid || alive[(r + buddy.shift) % old_size] < 0)
+        {
+            if (rank == 0)
+            {
+                fprintf(stderr, "Rank %d failed without a replica on a survivor: cannot recover in place\n", r);
+            }
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        from_replicas += dimension(r, old_size, total);
+    }
+
+    // Round 0 moves the survivors' own slices, round 1 the replicas of lost ranks
+    int *sendcounts = counts, *sdispls = counts + size, *recvcounts = counts + 2 * size, *rdispls = counts + 3 * size;
+    int64_t first = offset(rank, size, total);
+    int64_t count = dimension(rank, size, total);
+    for (int round = 0; round < 2; round++)
+    {
+        memset(counts, 0, 4 * (size_t)size * sizeof(int));
+
+        // This rank sends its slice, or the replica it holds if its owner is lost
+        int held = round == 0 ? old_rank : buddy.owner;
+        const counter_t *data = round == 0 || !buddy.replica ? counters : buddy.replica;
+        if (round == 0 || alive[held] < 0)
+        {
+            int64_t held_first = offset(held, old_size, total);
+            int64_t held_count = dimension(held, old_size, total);
+            for (int d = 0; d < size; d++)
+            {
+                int64_t lo;
+                int64_t n = shared(held_first, held_count, offset(d, size, total), dimension(d, size, total), &lo);
+                sendcounts[d] = (int)n;
+                sdispls[d] = (int)(n > 0 ? lo - held_first : 0);
+            }
+        }
+
+        // Every survivor computes what the others hold, so no counts are exchanged
+        for (int s = 0; s < size; s++)
+        {
+            int other = round == 0 ? old_ranks[s] : (old_ranks[s] - buddy.shift + old_size) % old_size;
+            if (round == 1 && alive[other] >= 0)
+            {
+                continue;
+            }
+            int64_t lo;
+            int64_t n = shared(offset(other, old_size, total), dimension(other, old_size, total), first, count, &lo);
+            recvcounts[s] = (int)n;
+            rdispls[s] = (int)(n > 0 ? lo - first : 0);
+        }
+        MPI_Alltoallv(data, sendcounts, sdispls, MPI_COUNTER, dst, recvcounts, rdispls, MPI_COUNTER, comm);
+    }
+
+    free(counts);
+    free(alive);
+    free(old_ranks);
+    return from_replicas;
+}
+
+void buddy_release(void)
+{
+    free(buddy.replica);
+    buddy.replica = NULL;
+    buddy.capacity = 0;
+#ifdef BUDDY_ULFM
+    if (buddy.handler != MPI_ERRHANDLER_NULL)
+    {
+        MPI_Errhandler_free(&buddy.handler);
+    }
+#endif
+}
@@ -0,0 +1,120 @@
+/**
+ * @file buddy.h
+ * @brief Buddy replicas of the counter slices and in-place recovery with ULFM.
+ *
+ * Without recovery, any process failure ends in MPI_Abort() and the job is
+ * resubmitted from the checkpoint on the shared filesystem. With --buddy=1,
+ * every rank also keeps a copy of the slice of another rank, its buddy, in
+ * memory: buddy_mirror() sends the slice to rank + shift and receives the one
+ * of rank - shift, where shift is the number of ranks on the largest node, so
+ * that with ranks placed node by node the copy lives on another node.
+ * Mirrors are taken at startup, after every restart() and with every periodic
+ * checkpoint.
+ *
+ * The job communicator runs with an error handler that, on MPIX_ERR_PROC_FAILED
+ * or MPIX_ERR_REVOKED, only records the failure and revokes the communicator,
+ * so every survivor sees it. The main loop checks buddy_failed() once per
+ * iteration and calls recover() (test.h), which
+ * - shrinks the communicator to the survivors (buddy_shrink()),
+ * - repartitions the counters over them with offset()/dimension(),
+ * - moves every survivor's own slice and, for every lost rank, the replica
+ *   its buddy holds to the new owners (buddy_rebuild()).
+ *
+ * Survivors keep their current counters; those of a lost rank restart from
+ * its last mirror. Counters are independent, so this is a consistent state.
+ * The job cannot recover if a rank and its buddy fail together.
+ *
+ * The shrunk communicator replaces dmr_get_world_comm() in every module
+ * (buddy_world_comm()). DMR keeps the revoked one, so no reconfiguration is
+ * requested after a recovery. Recovery needs an MPI with the ULFM extensions
+ * (MPIX_Comm_shrink, Open MPI 5 or an ULFM build, run with --with-ft ulfm).
+ * Without them --buddy=1 only warns. Work stealing and the node tier keep state
+ * on the failed communicator, so they are not supported with it.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef BUDDY_H
+#define BUDDY_H
+
+#include <mpi.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "counter.h"
+
+/**
+ * @brief Enables the replicas if cfg->buddy is set and the build supports recovery.
+ *
+ * @param rank Current MPI rank; rank 0 explains why the replicas stay off
+ * @param cfg Runtime configuration (buddy, ckpt_mode, steal_chunk)
+ */
+void buddy_init(int rank, const Config *cfg);
+
+/**
+ * @brief Sends the local slice to the buddy and keeps the slice of the rank it is the buddy of.
+ *
+ * Also installs the recovery error handler on comm.
+ *
+ * @param comm Job communicator
+ * @param rank Current MPI rank
+ * @param size Total number of MPI ranks
+ * @param counters Local counters
+ * @param num_counters Number of local counters
+ * @param cfg Runtime configuration (num_counters)
+ *
+ * @note Collective over comm; a no-op when the replicas are off
+ */
+void buddy_mirror(MPI_Comm comm, int rank, int size, const counter_t *counters, int64_t num_counters, const Config *cfg);
+
+/**
+ * @brief Tells whether a process failure has been detected on the job communicator.
+ *
+ * @note Local
+ */
+int buddy_failed(void);
+
+/**
+ * @brief Tells whether the job runs on a communicator recovered from a failure.
+ */
+int buddy_recovered(void);
+
+/**
+ * @brief Returns the job communicator: the recovered one after a failure, DMR's otherwise.
+ */
+MPI_Comm buddy_world_comm(void);
+
+/**
+ * @brief Revokes the failed communicator and replaces it with its survivors.
+ *
+ * @param old_size Output, number of ranks before the failure
+ * @return Communicator of the survivors, in the order of their old ranks
+ *
+ * @note Collective over the survivors
+ */
+MPI_Comm buddy_shrink(int *old_size);
+
+/**
+ * @brief Fills the slices of a layout of the survivors from their slices and the replicas.
+ *
+ * @param comm Communicator of the survivors
+ * @param old_rank Rank of this process before the failure
+ * @param old_size Number of ranks before the failure
+ * @param counters Counters of this process, its slice of the old layout
+ * @param dst Slice of the new layout to fill, dimension() counters of this rank
+ * @param cfg Runtime configuration (num_counters)
+ * @return Number of counters of the whole job taken from replicas
+ *
+ * @note Collective over comm; aborts if a lost rank's replica is lost too
+ */
+int64_t buddy_rebuild(MPI_Comm comm, int old_rank, int old_size, const counter_t *counters, counter_t *dst,
+                      const Config *cfg);
+
+/**
+ * @brief Frees the replica.
+ */
+void buddy_release(void);
+
+#endif /* BUDDY_H */
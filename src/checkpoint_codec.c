@@ -0,0 +1,357 @@
+/**
+ * @file checkpoint_codec.c
+ * @brief Implementation of the compressed checkpoint block encodings.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <string.h>
+
+#ifdef CKPT_WITH_ZSTD
+#include <zstd.h>
+#endif
+#ifdef CKPT_WITH_LZ4
+#include <lz4.h>
+#endif
+
+#include "checkpoint_codec.h"
+
+/** @brief zstd compression level: the fastest ones, checkpoints are bandwidth-bound */
+#define CKPT_ZSTD_LEVEL 1
+
+/**
+ * @brief Packs count values of bits bits each, returning the bytes written or 0 if a value does not fit.
+ */
+static uint32_t pack_encode(uint32_t bits, const int32_t *values, uint32_t count, uint8_t *out)
+{
+    uint64_t limit = (1ull << bits) - 1;
+    uint64_t acc = 0;
+    uint32_t filled = 0, pos = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (values[i] < 0 || (uint64_t)values[i] > limit)
+        {
+            return 0;
+        }
+        acc |= (uint64_t)values[i] << filled;
+        filled += bits;
+        while (filled >= 8)
+        {
+            out[pos++] = (uint8_t)acc;
+            acc >>= 8;
+            filled -= 8;
+        }
+    }
+    if (filled > 0)
+    {
+        out[pos++] = (uint8_t)acc;
+    }
+    return pos;
+}
+
+/**
+ * @brief Unpacks count values of bits bits each.
+ */
+static int pack_decode(uint32_t bits, const uint8_t *in, uint32_t bytes, uint32_t count, int32_t *values)
+{
+    if (bits == 0 || bits > 32 || bytes != ((uint64_t)count * bits + 7) / 8)
+    {
+        return -1;
+    }
+
+    uint64_t mask = (1ull << bits) - 1;
+    uint64_t acc = 0;
+    uint32_t filled = 0, pos = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        while (filled < bits)
+        {
+            acc |= (uint64_t)in[pos++] << filled;
+            filled += 8;
+        }
+        values[i] = (int32_t)(uint32_t)(acc & mask);
+        acc >>= bits;
+        filled -= bits;
+    }
+    return 0;
+}
+
+/**
+ * @brief Appends a LEB128 varint, returning -1 once capacity is exceeded.
+ */
+static int put_varint(uint8_t *out, uint32_t capacity, uint32_t *pos, uint32_t value)
+{
+    do
+    {
+        if (*pos >= capacity)
+        {
+            return -1;
+        }
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        out[(*pos)++] = byte | (value ? 0x80 : 0);
+    } while (value);
+    return 0;
+}
+
+/**
+ * @brief Reads a LEB128 varint of at most 5 bytes.
+ */
+static int get_varint(const uint8_t *in, uint32_t bytes, uint32_t *pos, uint32_t *value)
+{
+    uint32_t result = 0;
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        if (*pos >= bytes)
+        {
+            return -1;
+        }
+        uint8_t byte = in[(*pos)++];
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            *value = result;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Encodes runs of equal values, returning the bytes written or 0 if more than capacity are needed.
+ */
+static uint32_t rle_encode(const int32_t *values, uint32_t count, uint8_t *out, uint32_t capacity)
+{
+    uint32_t pos = 0;
+    for (uint32_t i = 0; i < count;)
+    {
+        uint32_t run = 1;
+        while (i + run < count && values[i + run] == values[i])
+        {
+            run++;
+        }
+        if (put_varint(out, capacity, &pos, run) != 0 || put_varint(out, capacity, &pos, (uint32_t)values[i]) != 0)
+        {
+            return 0;
+        }
+        i += run;
+    }
+    return pos;
+}
+
+/**
+ * @brief Expands runs of equal values, which must cover exactly count values.
+ */
+static int rle_decode(const uint8_t *in, uint32_t bytes, uint32_t count, int32_t *values)
+{
+    uint32_t pos = 0, filled = 0;
+    while (pos < bytes)
+    {
+        uint32_t run, value;
+        if (get_varint(in, bytes, &pos, &run) != 0 || get_varint(in, bytes, &pos, &value) != 0 || run == 0 ||
+            run > count - filled)
+        {
+            return -1;
+        }
+        for (uint32_t k = 0; k < run; k++)
+        {
+            values[filled + k] = (int32_t)value;
+        }
+        filled += run;
+    }
+    return filled == count ? 0 : -1;
+}
+
+/**
+ * @brief Runs the backend of codec over bytes of input, returning the output size or 0 if it does not fit.
+ */
+static uint32_t backend_compress(CheckpointCodec codec, const uint8_t *in, uint32_t bytes, uint8_t *out, uint32_t capacity)
+{
+#ifdef CKPT_WITH_ZSTD
+    if (codec == CKPT_CODEC_ZSTD)
+    {
+        size_t written = ZSTD_compress(out, capacity, in, bytes, CKPT_ZSTD_LEVEL);
+        return ZSTD_isError(written) ? 0 : (uint32_t)written;
+    }
+#endif
+#ifdef CKPT_WITH_LZ4
+    if (codec == CKPT_CODEC_LZ4)
+    {
+        int written = LZ4_compress_default((const char *)in, (char *)out, (int)bytes, (int)capacity);
+        return written > 0 ? (uint32_t)written : 0;
+    }
+#endif
+    (void)codec;
+    (void)in;
+    (void)bytes;
+    (void)out;
+    (void)capacity;
+    return 0;
+}
+
+/**
+ * @brief Undoes the backend pass flagged in encoding, which must give exactly inner_bytes.
+ */
+static int backend_decompress(uint32_t encoding, const uint8_t *in, uint32_t bytes, uint8_t *out, uint32_t inner_bytes)
+{
+#ifdef CKPT_WITH_ZSTD
+    if (encoding & CKPT_BLOCK_ZSTD)
+    {
+        size_t read = ZSTD_decompress(out, inner_bytes, in, bytes);
+        return !ZSTD_isError(read) && read == inner_bytes ? 0 : -1;
+    }
+#endif
+#ifdef CKPT_WITH_LZ4
+    if (encoding & CKPT_BLOCK_LZ4)
+    {
+        int read = LZ4_decompress_safe((const char *)in, (char *)out, (int)bytes, (int)inner_bytes);
+        return read >= 0 && (uint32_t)read == inner_bytes ? 0 : -1;
+    }
+#endif
+    (void)encoding;
+    (void)in;
+    (void)bytes;
+    (void)out;
+    (void)inner_bytes;
+    return -1;
+}
+
+uint32_t ckpt_codec_bits(int max_value)
+{
+    uint32_t bits = 1;
+    while (bits < 31 && ((uint32_t)max_value >> bits) != 0)
+    {
+        bits++;
+    }
+    return bits;
+}
+
+int ckpt_codec_available(CheckpointCodec codec)
+{
+    switch (codec)
+    {
+    case CKPT_CODEC_AUTO:
+    case CKPT_CODEC_PACK:
+    case CKPT_CODEC_RLE:
+        return 1;
+#ifdef CKPT_WITH_ZSTD
+    case CKPT_CODEC_ZSTD:
+        return 1;
+#endif
+#ifdef CKPT_WITH_LZ4
+    case CKPT_CODEC_LZ4:
+        return 1;
+#endif
+    default:
+        return 0;
+    }
+}
+
+uint32_t ckpt_codec_encode(CheckpointCodec codec, uint32_t bits, const int32_t *values, uint32_t count, uint8_t *out,
+                           uint8_t *scratch, CompressedBlock *block)
+{
+    uint32_t raw = count * (uint32_t)sizeof(int32_t);
+    uint32_t packed = (uint32_t)(((uint64_t)count * bits + 7) / 8);
+    int backend = codec == CKPT_CODEC_ZSTD || codec == CKPT_CODEC_LZ4;
+
+    // The backends compress the inner encoding, built in the scratch buffer
+    uint8_t *inner = backend ? scratch : out;
+    uint32_t bytes = 0;
+    uint32_t encoding = CKPT_BLOCK_RAW;
+
+    // Runs first: they win on saturated blocks, and must beat packing unless forced
+    if (codec != CKPT_CODEC_PACK)
+    {
+        uint32_t limit = codec == CKPT_CODEC_RLE || packed > raw ? raw : packed;
+        bytes = rle_encode(values, count, inner, limit - 1);
+        encoding = CKPT_BLOCK_RLE;
+    }
+    if (bytes == 0 && codec != CKPT_CODEC_RLE && packed < raw)
+    {
+        bytes = pack_encode(bits, values, count, inner);
+        encoding = CKPT_BLOCK_PACK;
+    }
+    if (bytes == 0)
+    {
+        memcpy(inner, values, raw);
+        bytes = raw;
+        encoding = CKPT_BLOCK_RAW;
+    }
+    block->count = count;
+    block->inner_bytes = bytes;
+    block->crc = ckpt_crc32c(0, values, raw);
+    block->reserved = 0;
+
+    // The backend output is kept only if it is smaller
+    if (backend)
+    {
+        uint32_t compressed = backend_compress(codec, inner, bytes, out, bytes - 1);
+        if (compressed > 0)
+        {
+            bytes = compressed;
+            encoding |= codec == CKPT_CODEC_ZSTD ? CKPT_BLOCK_ZSTD : CKPT_BLOCK_LZ4;
+        }
+        else
+        {
+            memcpy(out, inner, bytes);
+        }
+    }
+
+    block->encoding = encoding;
+    block->bytes = bytes;
+    return bytes;
+}
+
+int ckpt_codec_decode(const CompressedBlock *block, uint32_t bits, const uint8_t *in, uint8_t *scratch, int32_t *values)
+{
+    // Sizes come from the file: keep them within the buffers before trusting them
+    const uint32_t capacity = CKPT_CODEC_BLOCK * sizeof(int32_t);
+    if (block->count == 0 || block->count > CKPT_CODEC_BLOCK || block->bytes > capacity || block->inner_bytes > capacity)
+    {
+        return -1;
+    }
+
+    const uint8_t *inner = in;
+    if (block->encoding & (CKPT_BLOCK_ZSTD | CKPT_BLOCK_LZ4))
+    {
+        if (backend_decompress(block->encoding, in, block->bytes, scratch, block->inner_bytes) != 0)
+        {
+            return -1;
+        }
+        inner = scratch;
+    }
+    else if (block->inner_bytes != block->bytes)
+    {
+        return -1;
+    }
+
+    switch (block->encoding & CKPT_BLOCK_INNER)
+    {
+    case CKPT_BLOCK_RAW:
+        if (block->inner_bytes != block->count * sizeof(int32_t))
+        {
+            return -1;
+        }
+        memcpy(values, inner, block->inner_bytes);
+        break;
+    case CKPT_BLOCK_PACK:
+        if (pack_decode(bits, inner, block->inner_bytes, block->count, values) != 0)
+        {
+            return -1;
+        }
+        break;
+    case CKPT_BLOCK_RLE:
+        if (rle_decode(inner, block->inner_bytes, block->count, values) != 0)
+        {
+            return -1;
+        }
+        break;
+    default:
+        return -1;
+    }
+
+    // A block that decodes cleanly can still hold the wrong values
+    return ckpt_crc32c(0, values, block->count * sizeof(int32_t)) == block->crc ? 0 : -1;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file checkpoint_codec.h
+ * @brief Block encodings of the compressed checkpoint format.
+ *
+ * Counter values lie in [0, max_counter_value] and most of them sit at the
+ * maximum late in a run, so each block of a compressed checkpoint (see
+ * checkpoint_format.h) is stored with one of:
+ *
+ * | Encoding         | Layout                                                       |
+ * |------------------|--------------------------------------------------------------|
+ * | CKPT_BLOCK_RAW   | count int32 values, as in a binary checkpoint                 |
+ * | CKPT_BLOCK_PACK  | count values of `bits` bits, LSB first, padded to a byte      |
+ * | CKPT_BLOCK_RLE   | (run length, value) pairs, both LEB128 varints                |
+ *
+ * CKPT_CODEC_AUTO keeps the smaller of PACK and RLE for every block, PACK and
+ * RLE force one of them, and the zstd and lz4 codecs run a general-purpose
+ * compressor over the AUTO output, flagged with CKPT_BLOCK_ZSTD or
+ * CKPT_BLOCK_LZ4. A block that would not get smaller is stored RAW, so a block
+ * never takes more than 4 bytes per counter.
+ *
+ * The backends are optional: they are built in with make ZSTD=1 or make LZ4=1,
+ * which define CKPT_WITH_ZSTD or CKPT_WITH_LZ4. Like checkpoint_format.h,
+ * this module has no MPI or DMR dependency and uses status codes.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef CHECKPOINT_CODEC_H
+#define CHECKPOINT_CODEC_H
+
+#include <stdint.h>
+
+#include "config.h"
+#include "checkpoint_format.h"
+
+/** @brief Block stored as plain int32 values */
+#define CKPT_BLOCK_RAW 0u
+/** @brief Block stored bit-packed */
+#define CKPT_BLOCK_PACK 1u
+/** @brief Block stored as runs of equal values */
+#define CKPT_BLOCK_RLE 2u
+/** @brief Mask of the encoding bits below the backend flags */
+#define CKPT_BLOCK_INNER 0xFFu
+/** @brief Flag: the inner encoding was compressed with zstd */
+#define CKPT_BLOCK_ZSTD 0x100u
+/** @brief Flag: the inner encoding was compressed with LZ4 */
+#define CKPT_BLOCK_LZ4 0x200u
+
+/**
+ * @brief Returns the number of bits needed to pack values in [0, max_value].
+ *
+ * @param max_value Largest value to pack
+ * @return ceil(log2(max_value + 1)), at least 1
+ */
+uint32_t ckpt_codec_bits(int max_value);
+
+/**
+ * @brief Tells whether a codec is built in.
+ *
+ * @param codec Codec to check
+ * @return 1 if blocks can be written with codec, 0 otherwise
+ */
+int ckpt_codec_available(CheckpointCodec codec);
+
+/**
+ * @brief Encodes one block of counters.
+ *
+ * @param codec Codec to encode with
+ * @param bits Packing width, from ckpt_codec_bits()
+ * @param values Values of the block
+ * @param count Number of values, at most CKPT_CODEC_BLOCK
+ * @param out Output buffer of at least count * sizeof(int32_t) bytes
+ * @param scratch Work buffer of the same size, used by the backends
+ * @param block Index entry whose count, encoding, bytes, inner_bytes and crc are filled
+ * @return Number of bytes written to out
+ */
+uint32_t ckpt_codec_encode(CheckpointCodec codec, uint32_t bits, const int32_t *values, uint32_t count, uint8_t *out,
+                           uint8_t *scratch, CompressedBlock *block);
+
+/**
+ * @brief Decodes one block of counters.
+ *
+ * @param block Index entry of the block
+ * @param bits Packing width, from the file header
+ * @param in Encoded block, block->bytes bytes
+ * @param scratch Work buffer of CKPT_CODEC_BLOCK * sizeof(int32_t) bytes, used by the backends
+ * @param values Output array of block->count values
+ * @return 0 on success, -1 if the block is malformed, larger than CKPT_CODEC_BLOCK,
+ *         its backend is not built in or the decoded values fail the block CRC
+ */
+int ckpt_codec_decode(const CompressedBlock *block, uint32_t bits, const uint8_t *in, uint8_t *scratch, int32_t *values);
+
+#endif /* CHECKPOINT_CODEC_H */
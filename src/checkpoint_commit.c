@@ -0,0 +1,78 @@
+/**
+ * @file checkpoint_commit.c
+ * @brief Implementation of the atomic checkpoint commit.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "checkpoint_commit.h"
+
+void checkpoint_staged_path(char *out, size_t out_size, const Config *cfg)
+{
+    snprintf(out, out_size, "%s%s", cfg->filepath, CKPT_STAGED_SUFFIX);
+}
+
+void checkpoint_previous_path(char *out, size_t out_size, const Config *cfg)
+{
+    snprintf(out, out_size, "%s%s", cfg->filepath, CKPT_PREVIOUS_SUFFIX);
+}
+
+int checkpoint_commit_file(const Config *cfg)
+{
+    char staged[CKPT_PATH_SIZE], previous[CKPT_PATH_SIZE];
+    checkpoint_staged_path(staged, sizeof(staged), cfg);
+    checkpoint_previous_path(previous, sizeof(previous), cfg);
+
+    // The current generation becomes the previous one; the one before it is dropped
+    if (unlink(previous) != 0 && errno != ENOENT)
+    {
+        return -1;
+    }
+    if (link(cfg->filepath, previous) != 0 && errno != ENOENT)
+    {
+        // No hard links on this filesystem: restart() also looks at the previous file while the current one is missing
+        if (rename(cfg->filepath, previous) != 0)
+        {
+            return -1;
+        }
+    }
+    if (rename(staged, cfg->filepath) != 0)
+    {
+        return -1;
+    }
+
+    // The renames are only durable once the directory itself is on disk
+    int fd = open(cfg->checkpoint_dir, O_RDONLY | O_DIRECTORY);
+    if (fd >= 0)
+    {
+        fsync(fd);
+        close(fd);
+    }
+    return 0;
+}
+
+void checkpoint_commit(MPI_Comm comm, int rank, const Config *cfg)
+{
+    // Every rank must have closed the staged file before it is renamed
+    MPI_Barrier(comm);
+
+    int ok = 1;
+    if (rank == 0 && checkpoint_commit_file(cfg) != 0)
+    {
+        fprintf(stderr, "Failed to commit checkpoint %s: %s\n", cfg->filepath, strerror(errno));
+        ok = 0;
+    }
+    MPI_Bcast(&ok, 1, MPI_INT, 0, comm);
+    if (!ok)
+    {
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+}
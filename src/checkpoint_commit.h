@@ -0,0 +1,78 @@
+/**
+ * @file checkpoint_commit.h
+ * @brief Atomic replacement of the global checkpoint file.
+ *
+ * No writer updates cfg->filepath in place: every global checkpoint is written
+ * to the staged file <filepath>.tmp, flushed to stable storage, and committed
+ * here. The commit keeps the current file as the previous generation,
+ * <filepath>.prev (a hard link, so nothing is copied), renames the staged file
+ * over cfg->filepath and syncs the directory. A crash at any point leaves
+ * either the old or the new checkpoint at cfg->filepath, and the generation
+ * before it in <filepath>.prev, which restart() reads when the current file
+ * fails its checks.
+ *
+ * Every commit creates a new inode, so a slice mapped by counter_map.h keeps
+ * the values it was mapped with.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef CHECKPOINT_COMMIT_H
+#define CHECKPOINT_COMMIT_H
+
+#include <mpi.h>
+#include <stddef.h>
+
+#include "config.h"
+
+/** @brief Suffix of the file a checkpoint is written to before its commit */
+#define CKPT_STAGED_SUFFIX ".tmp"
+/** @brief Suffix of the previous generation of the global checkpoint */
+#define CKPT_PREVIOUS_SUFFIX ".prev"
+/** @brief Size of a buffer holding cfg->filepath and either suffix */
+#define CKPT_PATH_SIZE (sizeof(((Config *)0)->filepath) + 8)
+
+/**
+ * @brief Builds the path a global checkpoint is staged at.
+ *
+ * @param out Output buffer, CKPT_PATH_SIZE bytes
+ * @param out_size Size of out
+ * @param cfg Runtime configuration (filepath)
+ */
+void checkpoint_staged_path(char *out, size_t out_size, const Config *cfg);
+
+/**
+ * @brief Builds the path of the previous generation of the global checkpoint.
+ *
+ * @param out Output buffer, CKPT_PATH_SIZE bytes
+ * @param out_size Size of out
+ * @param cfg Runtime configuration (filepath)
+ */
+void checkpoint_previous_path(char *out, size_t out_size, const Config *cfg);
+
+/**
+ * @brief Commits the staged file: the current one becomes the previous generation.
+ *
+ * The staged file must already be on stable storage (fsync or MPI_File_sync).
+ *
+ * @param cfg Runtime configuration (filepath, checkpoint_dir)
+ * @return 0 on success, -1 if a rename failed (errno is set)
+ *
+ * @note Local operation, run by a single process
+ */
+int checkpoint_commit_file(const Config *cfg);
+
+/**
+ * @brief Commits a staged file written collectively, once every rank has closed it.
+ *
+ * @param comm Communicator of the ranks that wrote the staged file
+ * @param rank Rank in comm
+ * @param cfg Runtime configuration (filepath, checkpoint_dir)
+ *
+ * @note Collective over comm; rank 0 commits, every rank aborts if it failed
+ */
+void checkpoint_commit(MPI_Comm comm, int rank, const Config *cfg);
+
+#endif /* CHECKPOINT_COMMIT_H */
@@ -0,0 +1,406 @@
+/**
+ * @file checkpoint_format.c
+ * @brief Implementation of the binary checkpoint format helpers.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <cpuid.h>
+#include <nmmintrin.h>
+#endif
+
+#include "checkpoint_format.h"
+
+/** @brief CRC32C polynomial, bit-reversed */
+#define CRC32C_POLY 0x82F63B78u
+
+/** @brief Byte-wise lookup table of the portable CRC32C and the implementation picked at first use */
+static uint32_t crc_table[256];
+static uint32_t (*crc_update)(uint32_t crc, const uint8_t *data, size_t bytes);
+static pthread_once_t crc_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Portable CRC32C update, one table lookup per byte.
+ */
+static uint32_t crc_update_table(uint32_t crc, const uint8_t *data, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; i++)
+    {
+        crc = crc_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+/**
+ * @brief CRC32C update with the SSE4.2 crc32 instruction, eight bytes at a time.
+ */
+__attribute__((target("sse4.2"))) static uint32_t crc_update_sse42(uint32_t crc, const uint8_t *data, size_t bytes)
+{
+    uint64_t wide = crc;
+    for (; bytes >= 8; data += 8, bytes -= 8)
+    {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        wide = _mm_crc32_u64(wide, word);
+    }
+    crc = (uint32_t)wide;
+    for (; bytes > 0; data++, bytes--)
+    {
+        crc = _mm_crc32_u8(crc, *data);
+    }
+    return crc;
+}
+#endif
+
+/**
+ * @brief Builds the lookup table and picks the fastest implementation the CPU supports.
+ */
+static void crc_init(void)
+{
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (crc & 1 ? CRC32C_POLY : 0);
+        }
+        crc_table[i] = crc;
+    }
+    crc_update = crc_update_table;
+
+#if defined(__x86_64__) && defined(__GNUC__)
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSE4_2))
+    {
+        crc_update = crc_update_sse42;
+    }
+#endif
+}
+
+/**
+ * @brief Returns the first counter and the size of a writer's slice, as offset() and dimension() do.
+ */
+static void writer_slice(uint64_t num_counters, uint32_t writer_size, uint32_t writer, uint64_t *first, uint64_t *count)
+{
+    uint64_t base = num_counters / writer_size;
+    uint64_t extra = num_counters % writer_size;
+    *first = writer * base + (writer < extra ? writer : extra);
+    *count = base + (writer < extra ? 1 : 0);
+}
+
+/**
+ * @brief Returns the writer whose slice holds a global counter index.
+ */
+static uint32_t writer_of(uint64_t num_counters, uint32_t writer_size, uint64_t index)
+{
+    uint64_t base = num_counters / writer_size;
+    uint64_t extra = num_counters % writer_size;
+    if (index < extra * (base + 1))
+    {
+        return (uint32_t)(index / (base + 1));
+    }
+    return (uint32_t)(extra + (index - extra * (base + 1)) / base);
+}
+
+void ckpt_header_init(CheckpointHeader *header, uint64_t num_counters, uint32_t writer_size, uint64_t epoch, uint64_t checksum)
+{
+    memset(header, 0, sizeof(*header));
+    header->magic = CKPT_MAGIC;
+    header->version = CKPT_VERSION;
+    header->num_counters = num_counters;
+    header->elem_width = sizeof(int32_t);
+    header->writer_size = writer_size;
+    header->epoch = epoch;
+    header->checksum = checksum;
+}
+
+int ckpt_header_validate(const CheckpointHeader *header)
+{
+    if (!header || header->magic != CKPT_MAGIC)
+    {
+        return -1;
+    }
+    if (header->version < 1 || header->version > CKPT_VERSION || header->elem_width != sizeof(int32_t))
+    {
+        return -1;
+    }
+    return 0;
+}
+
+uint64_t ckpt_checksum(const int32_t *values, uint64_t first_index, uint64_t count)
+{
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < count; i++)
+    {
+        // Weight by position so that swapped values change the checksum
+        sum += (first_index + i + 1) * (uint64_t)(uint32_t)values[i];
+    }
+    return sum;
+}
+
+uint32_t ckpt_crc32c(uint32_t crc, const void *data, size_t bytes)
+{
+    pthread_once(&crc_once, crc_init);
+    return ~crc_update(~crc, data, bytes);
+}
+
+uint64_t ckpt_crc_count(uint64_t count)
+{
+    return (count + CKPT_CRC_BLOCK - 1) / CKPT_CRC_BLOCK;
+}
+
+void ckpt_crc_slice(const int32_t *values, uint64_t count, uint32_t *crcs)
+{
+    for (uint64_t b = 0; b * CKPT_CRC_BLOCK < count; b++)
+    {
+        uint64_t length = count - b * CKPT_CRC_BLOCK < CKPT_CRC_BLOCK ? count - b * CKPT_CRC_BLOCK : CKPT_CRC_BLOCK;
+        crcs[b] = ckpt_crc32c(0, values + b * CKPT_CRC_BLOCK, length * sizeof(int32_t));
+    }
+}
+
+int64_t ckpt_crc_position(uint64_t num_counters, uint32_t writer_size, uint32_t writer)
+{
+    // Slices have base + 1 counters for the first extra writers, base for the others
+    uint64_t base = num_counters / writer_size;
+    uint64_t extra = num_counters % writer_size;
+    uint64_t before = writer < extra ? writer : extra;
+    uint64_t blocks = before * ckpt_crc_count(base + 1) + (writer - before) * ckpt_crc_count(base);
+    return CKPT_HEADER_SIZE + (int64_t)(num_counters * sizeof(int32_t) + blocks * sizeof(uint32_t));
+}
+
+int ckpt_verify_slice(FILE *f, const CheckpointHeader *header, const int32_t *values, uint64_t first, uint64_t count)
+{
+    if (header->version < 2 || count == 0)
+    {
+        return 0;
+    }
+    uint64_t end = first + count;
+    if (header->writer_size == 0 || end > header->num_counters)
+    {
+        return -1;
+    }
+
+    int32_t *edge = NULL;
+    uint32_t *stored = NULL;
+    int status = 0;
+    for (uint32_t w = writer_of(header->num_counters, header->writer_size, first); status == 0 && w < header->writer_size; w++)
+    {
+        uint64_t w_first, w_count;
+        writer_slice(header->num_counters, header->writer_size, w, &w_first, &w_count);
+        if (w_first >= end)
+        {
+            break;
+        }
+
+        // The stored CRCs of the writer's blocks that overlap the slice, in one read
+        uint64_t b_first = (first > w_first ? first - w_first : 0) / CKPT_CRC_BLOCK;
+        uint64_t b_end = ckpt_crc_count((end < w_first + w_count ? end : w_first + w_count) - w_first);
+        uint32_t *grown = realloc(stored, (b_end - b_first) * sizeof(uint32_t));
+        if (!grown || fseeko(f, ckpt_crc_position(header->num_counters, header->writer_size, w) + (off_t)(b_first * sizeof(uint32_t)), SEEK_SET) != 0 ||
+            fread(grown, sizeof(uint32_t), b_end - b_first, f) != b_end - b_first)
+        {
+            free(grown ? grown : stored);
+            free(edge);
+            return -1;
+        }
+        stored = grown;
+
+        for (uint64_t b = b_first; status == 0 && b < b_end; b++)
+        {
+            uint64_t start = w_first + b * CKPT_CRC_BLOCK;
+            uint64_t length = w_first + w_count - start < CKPT_CRC_BLOCK ? w_first + w_count - start : CKPT_CRC_BLOCK;
+            const int32_t *data;
+
+            // Edge blocks extend past the slice: read them whole
+            if (start < first || start + length > end)
+            {
+                if (!edge && !(edge = malloc(CKPT_CRC_BLOCK * sizeof(int32_t))))
+                {
+                    status = -1;
+                    break;
+                }
+                if (fseeko(f, CKPT_HEADER_SIZE + (off_t)(start * sizeof(int32_t)), SEEK_SET) != 0 ||
+                    fread(edge, sizeof(int32_t), length, f) != length)
+                {
+                    status = -1;
+                    break;
+                }
+                data = edge;
+            }
+            else
+            {
+                data = values + (start - first);
+            }
+            if (ckpt_crc32c(0, data, length * sizeof(int32_t)) != stored[b - b_first])
+            {
+                status = -1;
+            }
+        }
+    }
+    free(stored);
+    free(edge);
+    return status;
+}
+
+int ckpt_write_binary(FILE *f, const int32_t *values, uint64_t count, uint64_t epoch, uint64_t checksum)
+{
+    uint64_t blocks = ckpt_crc_count(count);
+    uint32_t *crcs = malloc((blocks > 0 ? blocks : 1) * sizeof(uint32_t));
+    if (!crcs)
+    {
+        return -1;
+    }
+    ckpt_crc_slice(values, count, crcs);
+
+    CheckpointHeader header;
+    ckpt_header_init(&header, count, 1, epoch, checksum);
+    int ok = fwrite(&header, sizeof(header), 1, f) == 1 && fwrite(values, sizeof(int32_t), count, f) == count &&
+             fwrite(crcs, sizeof(uint32_t), blocks, f) == blocks;
+    free(crcs);
+    return ok ? 0 : -1;
+}
+
+int ckpt_read_header(FILE *f, CheckpointHeader *header)
+{
+    rewind(f);
+    if (fread(header, sizeof(*header), 1, f) == 1 && header->magic == CKPT_MAGIC)
+    {
+        return 0;
+    }
+
+    // Not a binary checkpoint: leave the stream at the start for text parsing
+    rewind(f);
+    return -1;
+}
+
+int ckpt_read_compressed_header(FILE *f, CompressedHeader *header)
+{
+    rewind(f);
+    if (fread(header, sizeof(*header), 1, f) == 1 && header->magic == CKPT_COMPRESSED_MAGIC)
+    {
+        return 0;
+    }
+
+    // Not a compressed checkpoint: leave the stream at the start for the other formats
+    rewind(f);
+    return -1;
+}
+
+long ckpt_convert_text_to_binary(const char *src, const char *dst)
+{
+    FILE *in = fopen(src, "r");
+    if (!in)
+    {
+        fprintf(stderr, "Could not open file %s for reading\n", src);
+        return -1;
+    }
+
+    // Load every line into a growable array
+    size_t capacity = 1024, count = 0;
+    int32_t *values = malloc(capacity * sizeof(int32_t));
+    char line[256];
+    while (values && fgets(line, sizeof(line), in))
+    {
+        if (count == capacity)
+        {
+            capacity *= 2;
+            int32_t *grown = realloc(values, capacity * sizeof(int32_t));
+            if (!grown)
+            {
+                free(values);
+                values = NULL;
+                break;
+            }
+            values = grown;
+        }
+        values[count++] = (int32_t)atoi(line);
+    }
+    fclose(in);
+
+    if (!values)
+    {
+        fprintf(stderr, "Memory allocation failed while converting %s\n", src);
+        return -1;
+    }
+
+    FILE *out = fopen(dst, "wb");
+    if (!out)
+    {
+        fprintf(stderr, "Could not open file %s for writing\n", dst);
+        free(values);
+        return -1;
+    }
+
+    int ok = ckpt_write_binary(out, values, count, 0, ckpt_checksum(values, 0, count)) == 0;
+    ok = (fclose(out) == 0) && ok;
+    free(values);
+
+    if (!ok)
+    {
+        fprintf(stderr, "Failed to write binary checkpoint %s\n", dst);
+        return -1;
+    }
+    return (long)count;
+}
+
+long ckpt_convert_binary_to_text(const char *src, const char *dst)
+{
+    FILE *in = fopen(src, "rb");
+    if (!in)
+    {
+        fprintf(stderr, "Could not open file %s for reading\n", src);
+        return -1;
+    }
+
+    CheckpointHeader header;
+    if (ckpt_read_header(in, &header) != 0 || ckpt_header_validate(&header) != 0)
+    {
+        fprintf(stderr, "File %s is not a valid binary checkpoint\n", src);
+        fclose(in);
+        return -1;
+    }
+
+    FILE *out = fopen(dst, "w");
+    if (!out)
+    {
+        fprintf(stderr, "Could not open file %s for writing\n", dst);
+        fclose(in);
+        return -1;
+    }
+
+    // Stream values one by one, verifying the checksum on the way
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < header.num_counters; i++)
+    {
+        int32_t value;
+        if (fread(&value, sizeof(value), 1, in) != 1)
+        {
+            fprintf(stderr, "Unexpected end of file in %s\n", src);
+            fclose(in);
+            fclose(out);
+            return -1;
+        }
+        sum += ckpt_checksum(&value, i, 1);
+        fprintf(out, "%d\n", value);
+    }
+    fclose(in);
+
+    if (fclose(out) != 0)
+    {
+        fprintf(stderr, "Failed to write text checkpoint %s\n", dst);
+        return -1;
+    }
+    if (sum != header.checksum)
+    {
+        fprintf(stderr, "Warning: Checksum mismatch in %s\n", src);
+    }
+    return (long)header.num_counters;
+}
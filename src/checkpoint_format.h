@@ -0,0 +1,272 @@
+/**
+ * @file checkpoint_format.h
+ * @brief Binary, fixed-width checkpoint file format.
+ *
+ * A binary checkpoint is a CheckpointHeader followed by a packed array of
+ * int32 counter values in global index order. Because every element has the
+ * same width, the value of global counter i lives at byte
+ * CKPT_HEADER_SIZE + i * sizeof(int32_t), so a rank can seek straight to its
+ * slice. This module has no MPI or DMR dependency and uses status codes, so it
+ * can be shared between the simulation and the offline converter tool.
+ *
+ * Since version 2, the counter array is followed by a table of CRC32C values,
+ * one per block of CKPT_CRC_BLOCK counters. Blocks start at the first counter
+ * of each writer's slice (offset() over writer_size ranks), so every rank
+ * computes the CRCs of its own blocks, and the table lists the blocks of
+ * writer 0, then writer 1, and so on. Both the position of a writer's CRCs and
+ * the file size follow from num_counters and writer_size (ckpt_crc_position()).
+ * Version 1 files, without the table, are still read.
+ *
+ * Delta checkpoints complement a binary base file. A delta file is a
+ * DeltaHeader followed by num_runs records, each a DeltaRun followed by
+ * length int32 values for the global indices start .. start + length - 1.
+ * Replaying the deltas of a base in sequence order gives the latest state.
+ *
+ * A compressed checkpoint is a CompressedHeader, an index of num_blocks
+ * CompressedBlock entries in global index order, then the encoded blocks. Every
+ * rank encodes its slice as blocks of at most CKPT_CODEC_BLOCK counters, so a
+ * block never spans two writers and a reader only decodes the blocks that
+ * overlap its own range (see checkpoint_codec.h for the block encodings).
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef CHECKPOINT_FORMAT_H
+#define CHECKPOINT_FORMAT_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/** @brief File magic, reads "DMRC" in a little-endian hex dump */
+#define CKPT_MAGIC 0x43524D44u
+/** @brief Current format version (2 adds the CRC32C tables) */
+#define CKPT_VERSION 2
+/** @brief Size in bytes of the on-disk header preceding the counter array */
+#define CKPT_HEADER_SIZE ((long)sizeof(CheckpointHeader))
+/** @brief Delta file magic, reads "DMRD" in a little-endian hex dump */
+#define CKPT_DELTA_MAGIC 0x44524D44u
+/** @brief Size in bytes of the on-disk header preceding the delta records */
+#define CKPT_DELTA_HEADER_SIZE ((long)sizeof(DeltaHeader))
+/** @brief Compressed file magic, reads "DMRZ" in a little-endian hex dump */
+#define CKPT_COMPRESSED_MAGIC 0x5A524D44u
+/** @brief Size in bytes of the on-disk header preceding the block index */
+#define CKPT_COMPRESSED_HEADER_SIZE ((long)sizeof(CompressedHeader))
+/** @brief Largest number of counters in one compressed block */
+#define CKPT_CODEC_BLOCK 65536
+/** @brief Counters covered by one CRC32C of a binary checkpoint */
+#define CKPT_CRC_BLOCK 65536
+
+/**
+ * @brief On-disk header of a binary checkpoint.
+ *
+ * Fields are laid out so that the structure has no padding (40 bytes).
+ */
+typedef struct
+{
+    uint32_t magic;        /**< Always CKPT_MAGIC */
+    uint32_t version;      /**< Format version, CKPT_VERSION when written */
+    uint64_t num_counters; /**< Number of counters stored in the file */
+    uint32_t elem_width;   /**< Width in bytes of one stored counter */
+    uint32_t writer_size;  /**< Number of ranks that wrote the checkpoint */
+    uint64_t epoch;        /**< Reconfiguration epoch the checkpoint belongs to */
+    uint64_t checksum;     /**< ckpt_checksum() over the whole counter array */
+} CheckpointHeader;
+
+/**
+ * @brief On-disk header of a delta checkpoint (48 bytes, no padding).
+ */
+typedef struct
+{
+    uint32_t magic;         /**< Always CKPT_DELTA_MAGIC */
+    uint32_t version;       /**< Format version, CKPT_VERSION when written */
+    uint64_t base_epoch;    /**< Epoch of the base checkpoint this delta applies to */
+    uint64_t epoch;         /**< Epoch of this delta */
+    uint64_t num_runs;      /**< Number of DeltaRun records that follow */
+    uint64_t payload_bytes; /**< Total size of the records following the header */
+    uint64_t checksum;      /**< Sum of ckpt_checksum() over every run */
+} DeltaHeader;
+
+/**
+ * @brief Header of one run of consecutive changed counters (16 bytes).
+ */
+typedef struct
+{
+    uint64_t start;    /**< Global index of the first counter of the run */
+    uint32_t length;   /**< Number of int32 values that follow */
+    uint32_t reserved; /**< Padding, always 0 */
+} DeltaRun;
+
+/**
+ * @brief On-disk header of a compressed checkpoint (56 bytes, no padding).
+ */
+typedef struct
+{
+    uint32_t magic;          /**< Always CKPT_COMPRESSED_MAGIC */
+    uint32_t version;        /**< Format version, CKPT_VERSION when written */
+    uint64_t num_counters;   /**< Number of counters stored in the file */
+    uint32_t writer_size;    /**< Number of ranks that wrote the checkpoint */
+    uint32_t bits;           /**< Width in bits of a bit-packed value */
+    uint64_t epoch;          /**< Reconfiguration epoch the checkpoint belongs to */
+    uint64_t checksum;       /**< ckpt_checksum() over the whole counter array */
+    uint64_t num_blocks;     /**< Number of CompressedBlock entries in the index */
+    uint32_t codec;          /**< CheckpointCodec the blocks were written with */
+    uint32_t block_counters; /**< CKPT_CODEC_BLOCK of the writer */
+} CompressedHeader;
+
+/**
+ * @brief Index entry of one compressed block (40 bytes).
+ */
+typedef struct
+{
+    uint64_t first;       /**< Global index of the first counter of the block */
+    uint64_t offset;      /**< Byte offset of the encoded block from the start of the file */
+    uint32_t count;       /**< Number of counters in the block */
+    uint32_t encoding;    /**< CKPT_BLOCK_* encoding, possibly with a backend flag */
+    uint32_t bytes;       /**< Size of the encoded block in the file */
+    uint32_t inner_bytes; /**< Size before the backend pass, equal to bytes without one */
+    uint32_t crc;         /**< ckpt_crc32c() of the decoded int32 values */
+    uint32_t reserved;    /**< Padding, always 0 */
+} CompressedBlock;
+
+/**
+ * @brief Fills a header for the current format version.
+ *
+ * @param header Header to fill
+ * @param num_counters Number of counters stored in the file
+ * @param writer_size Number of ranks that wrote the checkpoint
+ * @param epoch Reconfiguration epoch
+ * @param checksum Checksum of the whole counter array
+ */
+void ckpt_header_init(CheckpointHeader *header, uint64_t num_counters, uint32_t writer_size, uint64_t epoch, uint64_t checksum);
+
+/**
+ * @brief Validates magic, version (1 or 2) and element width of a header.
+ *
+ * @param header Header read from a file
+ * @return 0 if the header describes a file this build can read, -1 otherwise
+ */
+int ckpt_header_validate(const CheckpointHeader *header);
+
+/**
+ * @brief Computes the position-weighted checksum of a slice of counters.
+ *
+ * The checksum is the sum over the slice of (global index + 1) * value, modulo
+ * 2^64. Partial checksums of disjoint slices add up to the checksum of the
+ * whole array, so ranks can combine them with an MPI_SUM reduction.
+ *
+ * @param values Pointer to the slice values
+ * @param first_index Global index of values[0]
+ * @param count Number of values in the slice
+ * @return Partial checksum of the slice
+ */
+uint64_t ckpt_checksum(const int32_t *values, uint64_t first_index, uint64_t count);
+
+/**
+ * @brief Computes a CRC32C (Castagnoli), with the SSE4.2 instruction when the CPU has it.
+ *
+ * @param crc CRC of the preceding data, 0 to start
+ * @param data Data to add
+ * @param bytes Number of bytes of data
+ * @return CRC of the preceding data followed by data
+ */
+uint32_t ckpt_crc32c(uint32_t crc, const void *data, size_t bytes);
+
+/**
+ * @brief Returns the number of CRC blocks of a slice.
+ *
+ * @param count Number of counters in the slice
+ * @return ceil(count / CKPT_CRC_BLOCK)
+ */
+uint64_t ckpt_crc_count(uint64_t count);
+
+/**
+ * @brief Computes the CRC32C of every block of a slice.
+ *
+ * @param values Values of the slice
+ * @param count Number of values
+ * @param crcs Output array of ckpt_crc_count(count) CRCs
+ */
+void ckpt_crc_slice(const int32_t *values, uint64_t count, uint32_t *crcs);
+
+/**
+ * @brief Returns the byte offset of the first CRC of a writer.
+ *
+ * @param num_counters Number of counters in the file
+ * @param writer_size Number of ranks that wrote the file
+ * @param writer Rank of the writer; writer_size gives the size of a version 2 file
+ * @return Offset from the start of the file
+ */
+int64_t ckpt_crc_position(uint64_t num_counters, uint32_t writer_size, uint32_t writer);
+
+/**
+ * @brief Verifies the CRCs of every block overlapping a slice of a binary checkpoint.
+ *
+ * Blocks entirely inside the slice are checked against values; the blocks at its
+ * edges are read back from the file.
+ *
+ * @param f Binary checkpoint file
+ * @param header Header of the file
+ * @param values Values of the slice, already loaded
+ * @param first Global index of values[0]
+ * @param count Number of values
+ * @return 0 if all blocks match (always for version 1 files), -1 otherwise
+ */
+int ckpt_verify_slice(FILE *f, const CheckpointHeader *header, const int32_t *values, uint64_t first, uint64_t count);
+
+/**
+ * @brief Writes a complete binary checkpoint of one writer, CRC table included.
+ *
+ * @param f File open for writing, positioned at its start
+ * @param values Counter values
+ * @param count Number of values
+ * @param epoch Reconfiguration epoch
+ * @param checksum Checksum to store: ckpt_checksum() of the values at their global position
+ * @return 0 on success, -1 on a write error
+ */
+int ckpt_write_binary(FILE *f, const int32_t *values, uint64_t count, uint64_t epoch, uint64_t checksum);
+
+/**
+ * @brief Reads the header at the start of an open file.
+ *
+ * @param f File positioned anywhere; it is left positioned right after the header
+ *          on success and rewound to the start otherwise
+ * @param header Output header
+ * @return 0 if a binary header with the right magic was read, -1 otherwise
+ */
+int ckpt_read_header(FILE *f, CheckpointHeader *header);
+
+/**
+ * @brief Reads the header of a compressed checkpoint at the start of an open file.
+ *
+ * @param f File positioned anywhere; it is left positioned right after the header
+ *          (at the block index) on success and rewound to the start otherwise
+ * @param header Output header
+ * @return 0 if a compressed header was read (its version is checked by the reader),
+ *         -1 otherwise
+ */
+int ckpt_read_compressed_header(FILE *f, CompressedHeader *header);
+
+/**
+ * @brief Converts a line-oriented text checkpoint into the binary format.
+ *
+ * Both the variable-width files written by the node leaders and the
+ * fixed-width files written with MPI-IO are accepted.
+ *
+ * @param src Path of the text checkpoint
+ * @param dst Path of the binary checkpoint to create
+ * @return Number of converted counters, or -1 on error
+ */
+long ckpt_convert_text_to_binary(const char *src, const char *dst);
+
+/**
+ * @brief Converts a binary checkpoint back into one decimal value per line.
+ *
+ * @param src Path of the binary checkpoint
+ * @param dst Path of the text checkpoint to create
+ * @return Number of converted counters, or -1 on error
+ */
+long ckpt_convert_binary_to_text(const char *src, const char *dst);
+
+#endif /* CHECKPOINT_FORMAT_H */
@@ -0,0 +1,141 @@
+/**
+ * @file checkpoint_schedule.c
+ * @brief Implementation of the Young/Daly checkpoint schedule.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+
+#include "checkpoint_schedule.h"
+
+/** @brief State of the schedule */
+static struct
+{
+    int enabled;
+    double mtbf;      /**< Mean time between failures in seconds */
+    int verbosity;
+    double cost;      /**< Running estimate of the checkpoint cost, negative until measured */
+    double iteration; /**< Time of one iteration on the slowest rank, as last measured */
+    int interval;     /**< Iterations between checkpoints */
+    int since;        /**< Iterations since the last checkpoint */
+    double last;      /**< Time of the last checkpoint */
+} schedule = {0, 0.0, 0, -1.0, 0.0, 1, 0, 0.0};
+
+/**
+ * @brief Daly's optimal interval in seconds for a checkpoint cost and an MTBF.
+ */
+static double daly_interval(double cost, double mtbf)
+{
+    if (cost >= 2.0 * mtbf)
+    {
+        return mtbf;
+    }
+    double ratio = cost / (2.0 * mtbf);
+    return sqrt(2.0 * cost * mtbf) * (1.0 + sqrt(ratio) / 3.0 + ratio / 9.0) - cost;
+}
+
+/**
+ * @brief Converts the interval for the current cost and iteration time to iterations.
+ */
+static void plan_interval(int rank)
+{
+    double period = daly_interval(schedule.cost, schedule.mtbf);
+    double iteration = schedule.iteration > 1e-9 ? schedule.iteration : 1e-9;
+    double iterations = period / iteration;
+    int interval = iterations < 1.0 ? 1 : iterations > INT_MAX ? INT_MAX : (int)llround(iterations);
+
+    if (rank == 0 && schedule.verbosity >= 1 && interval != schedule.interval)
+    {
+        // First-order expected overhead: checkpoints plus half an interval lost per failure
+        double overhead = period > 0.0 ? schedule.cost / period + period / (2.0 * schedule.mtbf) : 0.0;
+        printf("Checkpoint schedule: cost %.3g s, MTBF %g s, interval %.3g s (%d iterations, %.1f%% expected overhead)\n",
+               schedule.cost, schedule.mtbf, period, interval, 100.0 * overhead);
+    }
+    schedule.interval = interval;
+}
+
+void checkpoint_schedule_init(const Config *cfg)
+{
+    schedule.enabled = cfg->mtbf > 0.0;
+    schedule.mtbf = cfg->mtbf;
+    schedule.verbosity = cfg->verbosity;
+    schedule.cost = -1.0;
+    schedule.iteration = 0.0;
+    schedule.interval = 1;
+    schedule.since = 0;
+    schedule.last = MPI_Wtime();
+}
+
+int checkpoint_schedule_due(void)
+{
+    if (!schedule.enabled)
+    {
+        return 0;
+    }
+    return ++schedule.since >= schedule.interval;
+}
+
+void checkpoint_schedule_observe(MPI_Comm comm, int rank, double seconds)
+{
+    if (!schedule.enabled)
+    {
+        return;
+    }
+
+    // The slowest rank sets both the cost and the pace of the iterations
+    double now = MPI_Wtime();
+    double local[2] = {seconds, (now - schedule.last - seconds) / (schedule.since > 0 ? schedule.since : 1)};
+    double global[2];
+    MPI_Allreduce(local, global, 2, MPI_DOUBLE, MPI_MAX, comm);
+    schedule.since = 0;
+    schedule.last = now;
+
+    if (schedule.cost < 0.0)
+    {
+        schedule.cost = global[0];
+    }
+    else
+    {
+        schedule.cost += SCHEDULE_SMOOTHING * (global[0] - schedule.cost);
+    }
+    schedule.iteration = global[1];
+    plan_interval(rank);
+}
+
+void checkpoint_schedule_resize(MPI_Comm comm, int rank, int old_size)
+{
+    if (!schedule.enabled)
+    {
+        return;
+    }
+
+    // Spawned ranks take the estimates of rank 0, which always survives a resize
+    int size;
+    MPI_Comm_size(comm, &size);
+    double state[3] = {schedule.cost, schedule.iteration, (double)old_size};
+    MPI_Bcast(state, 3, MPI_DOUBLE, 0, comm);
+    checkpoint_schedule_reset();
+    if (state[0] < 0.0 || state[2] == size)
+    {
+        schedule.cost = state[0];
+        schedule.iteration = state[1];
+        return;
+    }
+
+    // Both the checkpoint and the iteration scale with the slice of the slowest rank
+    double scale = state[2] / size;
+    schedule.cost = state[0] * scale;
+    schedule.iteration = state[1] * scale;
+    plan_interval(rank);
+}
+
+void checkpoint_schedule_reset(void)
+{
+    schedule.since = 0;
+    schedule.last = MPI_Wtime();
+}
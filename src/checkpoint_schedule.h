@@ -0,0 +1,89 @@
+/**
+ * @file checkpoint_schedule.h
+ * @brief Periodic fault-tolerance checkpoints at the Young/Daly interval.
+ *
+ * Without --async-interval, checkpoints are only written when DMR
+ * reconfigures, so a failure loses everything since the last resize. With
+ * --mtbf=S the main loop asks checkpoint_schedule_due() every iteration and
+ * starts an asynchronous checkpoint (async_checkpoint.h) when the optimal
+ * interval has elapsed, independently of reconfigurations.
+ *
+ * For a checkpoint cost C and a mean time between failures M, Daly's
+ * higher-order estimate of the interval minimizing the expected lost time is
+ *
+ *     T = sqrt(2CM) * (1 + sqrt(C / 2M) / 3 + (C / 2M) / 9) - C    for C < 2M
+ *     T = M                                                        otherwise
+ *
+ * which reduces to Young's sqrt(2CM) for C << M. C is measured: the time the
+ * ranks spend in checkpoint_async_begin(), the slowest rank's, including the
+ * wait for the previous checkpoint when it is still in flight, smoothed over
+ * the checkpoints. The first checkpoint is written after the first iteration
+ * to get a measure. T is converted to iterations with the measured iteration
+ * time, so every rank makes the same decision without communicating; the ranks
+ * only agree on C and the iteration time once per checkpoint.
+ *
+ * A checkpoint written by a reconfiguration restarts the interval, except in
+ * CKPT_MODE_MEMORY, which writes no file. A resize keeps the measured cost and
+ * iteration time, scaled by the change of the slice size, restarts the interval,
+ * and hands the estimates of rank 0 to the spawned ranks in restart(), so every
+ * rank keeps making the same decision.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef CHECKPOINT_SCHEDULE_H
+#define CHECKPOINT_SCHEDULE_H
+
+#include <mpi.h>
+
+#include "config.h"
+
+/** @brief Weight of the last measured checkpoint cost in the running estimate */
+#define SCHEDULE_SMOOTHING 0.3
+
+/**
+ * @brief Starts the schedule; a no-op schedule if cfg->mtbf is 0.
+ *
+ * @param cfg Runtime configuration (mtbf, verbosity)
+ */
+void checkpoint_schedule_init(const Config *cfg);
+
+/**
+ * @brief Counts one iteration and tells whether a checkpoint is due.
+ *
+ * @return 1 if the interval has elapsed, 0 otherwise or if the schedule is off
+ *
+ * @note Local; every rank returns the same value for the same iteration
+ */
+int checkpoint_schedule_due(void);
+
+/**
+ * @brief Records the cost of the checkpoint just started and computes the next interval.
+ *
+ * @param comm Communicator of the checkpoint
+ * @param rank Rank in comm; rank 0 reports interval changes
+ * @param seconds Time this rank spent starting the checkpoint
+ *
+ * @note Collective over comm
+ */
+void checkpoint_schedule_observe(MPI_Comm comm, int rank, double seconds);
+
+/**
+ * @brief Carries the estimates over a reconfiguration and restarts the interval.
+ *
+ * @param comm Communicator after the reconfiguration
+ * @param rank Rank in comm; rank 0 provides the estimates and reports interval changes
+ * @param old_size Communicator size before the reconfiguration, read on rank 0 only
+ *
+ * @note Collective over comm; spawned ranks must have called checkpoint_schedule_init()
+ */
+void checkpoint_schedule_resize(MPI_Comm comm, int rank, int old_size);
+
+/**
+ * @brief Restarts the interval after a checkpoint written outside the schedule.
+ */
+void checkpoint_schedule_reset(void);
+
+#endif /* CHECKPOINT_SCHEDULE_H */
@@ -0,0 +1,49 @@
+/**
+ * @file ckpt_convert.c
+ * @brief Offline converter between text and binary checkpoint files.
+ *
+ * Usage:
+ *   ckpt_convert to-binary <text_checkpoint> <binary_checkpoint>
+ *   ckpt_convert to-text   <binary_checkpoint> <text_checkpoint>
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "checkpoint_format.h"
+
+int main(int argc, char *argv[])
+{
+    if (argc != 4)
+    {
+        fprintf(stderr, "Usage: %s to-binary|to-text <src> <dst>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    long converted;
+    if (strcmp(argv[1], "to-binary") == 0)
+    {
+        converted = ckpt_convert_text_to_binary(argv[2], argv[3]);
+    }
+    else if (strcmp(argv[1], "to-text") == 0)
+    {
+        converted = ckpt_convert_binary_to_text(argv[2], argv[3]);
+    }
+    else
+    {
+        fprintf(stderr, "Unknown direction '%s'\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    if (converted < 0)
+    {
+        return EXIT_FAILURE;
+    }
+
+    printf("Converted %ld counters from %s to %s\n", converted, argv[2], argv[3]);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,269 @@
+/**
+ * @file compressed_checkpoint.c
+ * @brief Implementation of the compressed checkpoints.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include "test.h"
+#include "checkpoint_codec.h"
+#include "compressed_checkpoint.h"
+#include "checkpoint_commit.h"
+#include "arena.h"
+#include "partition.h"
+#include "buddy.h"
+
+/**
+ * @brief Builds the datatype of one index entry, so that index counts stay in blocks.
+ */
+static MPI_Datatype block_type(void)
+{
+    MPI_Datatype type;
+    MPI_Type_contiguous(sizeof(CompressedBlock), MPI_BYTE, &type);
+    MPI_Type_commit(&type);
+    return type;
+}
+
+void checkpoint_compressed(int rank, int size, counter_t *counters, int64_t num_counters, const Config *cfg)
+{
+    MPI_Comm comm = buddy_world_comm();
+    int64_t first = offset(rank, size, cfg->num_counters);
+    uint32_t bits = ckpt_codec_bits(cfg->max_counter_value);
+
+    // No block is stored larger than its raw values
+    int64_t num_blocks = (num_counters + CKPT_CODEC_BLOCK - 1) / CKPT_CODEC_BLOCK;
+    CompressedBlock *index = malloc((num_blocks > 0 ? num_blocks : 1) * sizeof(CompressedBlock));
+    uint8_t *payload = arena_acquire((size_t)(num_counters > 0 ? num_counters : 1) * sizeof(int32_t));
+    uint8_t *scratch = malloc(CKPT_CODEC_BLOCK * sizeof(int32_t));
+    int32_t *wide = malloc(CKPT_CODEC_BLOCK * sizeof(int32_t));
+    if (!index || !scratch || !wide)
+    {
+        fprintf(stderr, "Memory allocation failed on rank %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    // Local block count, encoded bytes and partial checksum
+    uint64_t local[3] = {(uint64_t)num_blocks, 0, counter_checksum(counters, first, num_counters)};
+    for (int64_t b = 0; b < num_blocks; b++)
+    {
+        int64_t start = b * CKPT_CODEC_BLOCK;
+        uint32_t count = num_counters - start < CKPT_CODEC_BLOCK ? (uint32_t)(num_counters - start) : CKPT_CODEC_BLOCK;
+        index[b].first = (uint64_t)(first + start);
+        index[b].offset = local[1];
+
+        // The codecs encode the int32 values of the file, narrow counters are widened one block at a time
+#if COUNTER_IS_INT32
+        const int32_t *values = counters + start;
+#else
+        counter_widen(wide, counters + start, count);
+        const int32_t *values = wide;
+#endif
+        local[1] += ckpt_codec_encode(cfg->codec, bits, values, count, payload + local[1], scratch, &index[b]);
+    }
+    free(scratch);
+    free(wide);
+
+    uint64_t global[3];
+    MPI_Allreduce(local, global, 3, MPI_UINT64_T, MPI_SUM, comm);
+
+    // Each rank's entries and blocks go right after those of the slices before its own, so the
+    // index stays in global order whatever the mapping of slices to ranks
+    uint64_t position[2] = {0, 0};
+    const Partition *layout = partition_get(size, cfg->num_counters);
+    if (!layout->block_of)
+    {
+        MPI_Exscan(local, position, 2, MPI_UINT64_T, MPI_SUM, comm);
+        if (rank == 0)
+        {
+            position[0] = 0;
+            position[1] = 0;
+        }
+    }
+    else
+    {
+        uint64_t *all = malloc(2 * (size_t)size * sizeof(uint64_t));
+        if (!all)
+        {
+            fprintf(stderr, "Memory allocation failed on rank %d\n", rank);
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        MPI_Allgather(local, 2, MPI_UINT64_T, all, 2, MPI_UINT64_T, comm);
+        for (int b = 0; b < partition_block(layout, rank); b++)
+        {
+            int r = partition_rank(layout, b);
+            position[0] += all[2 * r];
+            position[1] += all[2 * r + 1];
+        }
+        free(all);
+    }
+    MPI_Offset data_start = CKPT_COMPRESSED_HEADER_SIZE + (MPI_Offset)global[0] * sizeof(CompressedBlock);
+    for (int64_t b = 0; b < num_blocks; b++)
+    {
+        index[b].offset += (uint64_t)data_start + position[1];
+    }
+
+    char staged[CKPT_PATH_SIZE];
+    checkpoint_staged_path(staged, sizeof(staged), cfg);
+    MPI_File fh;
+    if (MPI_File_open(comm, staged, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+    {
+        fprintf(stderr, "Could not open file %s with MPI-IO on rank %d\n", staged, rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    MPI_File_set_size(fh, data_start + (MPI_Offset)global[1]);
+
+    uint64_t epoch = checkpoint_next_epoch();
+    if (rank == 0)
+    {
+        CompressedHeader header = {CKPT_COMPRESSED_MAGIC, CKPT_VERSION, (uint64_t)cfg->num_counters, (uint32_t)size, bits,
+                                   epoch, global[2], global[0], (uint32_t)cfg->codec, CKPT_CODEC_BLOCK};
+        if (MPI_File_write_at(fh, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE) != MPI_SUCCESS)
+        {
+            fprintf(stderr, "Failed to write checkpoint header to %s\n", staged);
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+    }
+
+    // Entries are counted in blocks and the payload spans a single datatype: neither count overflows an int
+    MPI_Datatype entries = block_type();
+    MPI_Datatype blocks = checkpoint_byte_type(local[1]);
+    MPI_Offset index_position = CKPT_COMPRESSED_HEADER_SIZE + (MPI_Offset)position[0] * sizeof(CompressedBlock);
+    int written = MPI_File_write_at_all(fh, index_position, index, (int)num_blocks, entries, MPI_STATUS_IGNORE) == MPI_SUCCESS &&
+                  MPI_File_write_at_all(fh, data_start + (MPI_Offset)position[1], payload, 1, blocks, MPI_STATUS_IGNORE) == MPI_SUCCESS;
+    MPI_Type_free(&entries);
+    MPI_Type_free(&blocks);
+    if (!written)
+    {
+        fprintf(stderr, "Collective write to %s failed on rank %d\n", staged, rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    MPI_File_sync(fh);
+    MPI_File_close(&fh);
+    free(index);
+    arena_release(payload);
+    checkpoint_commit(comm, rank, cfg);
+
+    if (rank == 0 && cfg->verbosity >= 1)
+    {
+        double raw = (double)cfg->num_counters * sizeof(int32_t);
+        printf("Compressed checkpoint (%s): %llu bytes of values, %.1fx smaller than binary\n",
+               checkpoint_codec_name(cfg->codec), (unsigned long long)global[1], global[1] > 0 ? raw / global[1] : 0.0);
+    }
+}
+
+int compressed_restore(int rank, FILE *f, const CompressedHeader *header, counter_t *counters, int64_t first,
+                       int64_t num_counters, int64_t keep_first, int64_t keep_count, const Config *cfg)
+{
+    MPI_Comm comm = buddy_world_comm();
+
+    // The header is the same on every rank, and so is the outcome of this check
+    if (header->version != CKPT_VERSION || header->num_counters != (uint64_t)cfg->num_counters ||
+        header->num_blocks == 0 || header->num_blocks > header->num_counters || header->bits == 0 || header->bits > 32)
+    {
+        if (rank == 0)
+        {
+            fprintf(stderr, "Incompatible compressed checkpoint (version %u, %llu counters, %llu blocks)\n", header->version,
+                    (unsigned long long)header->num_counters, (unsigned long long)header->num_blocks);
+        }
+        return -1;
+    }
+
+    // One read of the index, shared with every rank
+    size_t index_bytes = header->num_blocks * sizeof(CompressedBlock);
+    CompressedBlock *index = malloc(index_bytes);
+    uint8_t *in = malloc(CKPT_CODEC_BLOCK * sizeof(int32_t));
+    uint8_t *scratch = malloc(CKPT_CODEC_BLOCK * sizeof(int32_t));
+    int32_t *values = malloc(CKPT_CODEC_BLOCK * sizeof(int32_t));
+    if (!index || !in || !scratch || !values)
+    {
+        fprintf(stderr, "Memory allocation failed on rank %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    int read_ok = rank != 0 || fread(index, 1, index_bytes, f) == index_bytes;
+    MPI_Bcast(&read_ok, 1, MPI_INT, 0, comm);
+    if (!read_ok)
+    {
+        if (rank == 0)
+        {
+            fprintf(stderr, "Corrupted compressed checkpoint (truncated index)\n");
+        }
+        free(index);
+        free(in);
+        free(scratch);
+        free(values);
+        return -1;
+    }
+    MPI_Datatype entries = block_type();
+    MPI_Bcast(index, (int)header->num_blocks, entries, 0, comm);
+    MPI_Type_free(&entries);
+
+    // Blocks are in global order: find the first one ending past the start of the slice
+    uint64_t lo = 0, hi = header->num_blocks;
+    while (lo < hi)
+    {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (index[mid].first + index[mid].count <= (uint64_t)first)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    // Decode the overlapping blocks; they must cover the slice without gaps
+    const char *error = NULL;
+    uint64_t next = (uint64_t)first;
+    uint64_t end = (uint64_t)(first + num_counters);
+    for (uint64_t b = lo; b < header->num_blocks && next < end; b++)
+    {
+        const CompressedBlock *block = &index[b];
+        if (block->first > next || block->first + block->count <= next)
+        {
+            error = "gap in the index";
+            break;
+        }
+
+        // A block whose values are all kept in memory is not read at all
+        uint64_t stop = block->first + block->count < end ? block->first + block->count : end;
+        if (next >= (uint64_t)keep_first && stop <= (uint64_t)(keep_first + keep_count))
+        {
+            next = stop;
+            continue;
+        }
+
+        // Blocks inside the slice are decoded in place, as long as counters are int32 values
+        int inside = COUNTER_IS_INT32 && block->first >= (uint64_t)first && block->first + block->count <= end;
+        int32_t *target = inside ? (int32_t *)counters + (block->first - first) : values;
+        if (block->bytes > CKPT_CODEC_BLOCK * sizeof(int32_t) || fseeko(f, (off_t)block->offset, SEEK_SET) != 0 ||
+            fread(in, 1, block->bytes, f) != block->bytes || ckpt_codec_decode(block, header->bits, in, scratch, target) != 0)
+        {
+            error = "unreadable block";
+            break;
+        }
+
+        if (!inside && counter_narrow(counters + (next - first), values + (next - block->first), (int64_t)(stop - next)) != 0)
+        {
+            error = "value out of range";
+            break;
+        }
+        next = stop;
+    }
+    free(index);
+    free(in);
+    free(scratch);
+    free(values);
+    if (!error && next < end)
+    {
+        error = "missing blocks";
+    }
+    if (error)
+    {
+        fprintf(stderr, "Corrupted compressed checkpoint (%s) on rank %d\n", error, rank);
+        return -1;
+    }
+    return 0;
+}
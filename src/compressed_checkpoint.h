@@ -0,0 +1,64 @@
+/**
+ * @file compressed_checkpoint.h
+ * @brief Checkpoints of compressed blocks with a global block index.
+ *
+ * In CKPT_MODE_COMPRESSED, every rank encodes its slice in blocks of at most
+ * CKPT_CODEC_BLOCK counters with cfg->codec (see checkpoint_codec.h). A prefix
+ * sum over the ranks gives each of them the position of its index entries and
+ * of its encoded blocks, which all ranks then write in two collective MPI-IO
+ * calls into the global checkpoint file (layout in checkpoint_format.h).
+ *
+ * On restart, rank 0 reads the index and broadcasts it, and every rank reads
+ * and decodes only the blocks overlapping its new slice. Every decoded block is
+ * checked against its CRC32C, and restart() verifies the global checksum as for
+ * a binary checkpoint.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef COMPRESSED_CHECKPOINT_H
+#define COMPRESSED_CHECKPOINT_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "config.h"
+#include "checkpoint_format.h"
+#include "counter.h"
+
+/**
+ * @brief Writes a compressed checkpoint of every slice into the global file.
+ *
+ * @param rank Current MPI rank
+ * @param size Total number of MPI ranks
+ * @param counters Pointer to the local counters array
+ * @param num_counters Number of counters in the local array
+ * @param cfg Runtime configuration (filepath, codec, max_counter_value, verbosity)
+ *
+ * @note Collective over buddy_world_comm(): every rank must call it
+ */
+void checkpoint_compressed(int rank, int size, counter_t *counters, int64_t num_counters, const Config *cfg);
+
+/**
+ * @brief Loads this rank's slice from a compressed checkpoint.
+ *
+ * @param rank Current MPI rank
+ * @param f Checkpoint file, positioned right after the header
+ * @param header Header read with ckpt_read_compressed_header()
+ * @param counters Local counters array to fill
+ * @param first Global index of counters[0]
+ * @param num_counters Number of counters in the local array
+ * @param keep_first Global index of the first counter already in place
+ * @param keep_count Number of counters already in place; blocks holding only those are skipped
+ * @param cfg Runtime configuration (global counter count)
+ * @return 0 on success, -1 if the file is incompatible or a block is malformed or fails its CRC
+ *
+ * @note Collective over buddy_world_comm(); every rank returns, so the caller can
+ *       agree on the outcome and verify the global checksum
+ */
+int compressed_restore(int rank, FILE *f, const CompressedHeader *header, counter_t *counters, int64_t first,
+                       int64_t num_counters, int64_t keep_first, int64_t keep_count, const Config *cfg);
+
+#endif /* COMPRESSED_CHECKPOINT_H */
@@ -0,0 +1,230 @@
+/**
+ * @file compute_kernel.c
+ * @brief Implementation of the sleep, STREAM triad and FMA compute kernels.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "compute_kernel.h"
+
+/** @brief Independent multiply-add chains of the FMA kernel (enough to fill the FMA pipelines) */
+#define FMA_LANES 32
+/** @brief Multiplier of the FMA chains; with FMA_ADD keeps every lane bounded near 1 */
+#define FMA_MUL 0.999999
+/** @brief Addend of the FMA chains */
+#define FMA_ADD 0.000001
+/** @brief Scalar of the STREAM triad */
+#define TRIAD_SCALAR 3.0
+
+/** @brief Kernel state of one thread: triad buffers, FMA chains and the work it measured */
+typedef struct
+{
+    double *triad_a, *triad_b, *triad_c;
+    int64_t triad_length;
+    double fma_state[FMA_LANES];
+    int fma_ready;
+    double work_done, busy_time;
+} KernelSlot;
+
+/** @brief One slot per thread, allocated by that thread on first use so its pages are local */
+static KernelSlot *slots[MAX_THREADS];
+
+/**
+ * @brief Returns the slot of the calling thread.
+ */
+static KernelSlot *slot_get(void)
+{
+#ifdef _OPENMP
+    int thread = omp_get_thread_num();
+#else
+    int thread = 0;
+#endif
+    if (!slots[thread])
+    {
+        slots[thread] = calloc(1, sizeof(KernelSlot));
+        if (!slots[thread])
+        {
+            fprintf(stderr, "Memory allocation failed for compute kernel state\n");
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+    }
+    return slots[thread];
+}
+
+/**
+ * @brief Reads the monotonic clock in seconds (MPI_Wtime is reserved to the main thread).
+ */
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Frees the triad buffers of a slot.
+ */
+static void triad_free(KernelSlot *slot)
+{
+    free(slot->triad_a);
+    free(slot->triad_b);
+    free(slot->triad_c);
+    slot->triad_a = slot->triad_b = slot->triad_c = NULL;
+    slot->triad_length = 0;
+}
+
+/**
+ * @brief Allocates and first-touches the triad buffers of a slot for the given length.
+ */
+static void triad_prepare(KernelSlot *slot, int64_t length)
+{
+    if (length == slot->triad_length)
+    {
+        return;
+    }
+    triad_free(slot);
+
+    slot->triad_a = malloc(length * sizeof(double));
+    slot->triad_b = malloc(length * sizeof(double));
+    slot->triad_c = malloc(length * sizeof(double));
+    if (!slot->triad_a || !slot->triad_b || !slot->triad_c)
+    {
+        fprintf(stderr, "Memory allocation failed for %lld-element compute buffers\n", (long long)length);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    for (int64_t i = 0; i < length; i++)
+    {
+        slot->triad_a[i] = 0.0;
+        slot->triad_b[i] = 1.0;
+        slot->triad_c[i] = 2.0;
+    }
+    slot->triad_length = length;
+}
+
+/**
+ * @brief One STREAM triad pass; restrict and the simd pragma let the compiler vectorize the loop.
+ */
+static void triad(double *restrict a, const double *restrict b, const double *restrict c, int64_t length)
+{
+#pragma omp simd
+    for (int64_t i = 0; i < length; i++)
+    {
+        a[i] = b[i] + TRIAD_SCALAR * c[i];
+    }
+}
+
+/**
+ * @brief Runs the FMA chains of a slot for the given number of iterations.
+ */
+static void fma_chains(KernelSlot *slot, int64_t iterations)
+{
+    double x[FMA_LANES];
+    for (int j = 0; j < FMA_LANES; j++)
+    {
+        x[j] = slot->fma_ready ? slot->fma_state[j] : 1.0 + j * 1e-3;
+    }
+
+    // Lanes are independent, so the inner loop maps onto SIMD multiply-adds
+    for (int64_t it = 0; it < iterations; it++)
+    {
+#pragma omp simd
+        for (int j = 0; j < FMA_LANES; j++)
+        {
+            x[j] = x[j] * FMA_MUL + FMA_ADD;
+        }
+    }
+
+    for (int j = 0; j < FMA_LANES; j++)
+    {
+        slot->fma_state[j] = x[j];
+    }
+    slot->fma_ready = 1;
+}
+
+void compute_kernel_run(const Config *cfg)
+{
+    switch (cfg->kernel)
+    {
+    case COMPUTE_KERNEL_STREAM:
+    {
+        KernelSlot *slot = slot_get();
+        triad_prepare(slot, cfg->work_size);
+        double start = now();
+        triad(slot->triad_a, slot->triad_b, slot->triad_c, slot->triad_length);
+        slot->busy_time += now() - start;
+        slot->work_done += 3.0 * sizeof(double) * (double)slot->triad_length;
+        break;
+    }
+    case COMPUTE_KERNEL_FMA:
+    {
+        KernelSlot *slot = slot_get();
+        double start = now();
+        fma_chains(slot, cfg->work_size);
+        slot->busy_time += now() - start;
+        slot->work_done += 2.0 * FMA_LANES * (double)cfg->work_size;
+        break;
+    }
+    case COMPUTE_KERNEL_SLEEP:
+    default:
+        // Simulate computational work by sleeping for the configured time period
+        if (cfg->compute_time > 0)
+        {
+            struct timespec delay;
+            delay.tv_sec = (time_t)cfg->compute_time;
+            delay.tv_nsec = (long)((cfg->compute_time - (double)delay.tv_sec) * 1e9);
+            nanosleep(&delay, NULL);
+        }
+        break;
+    }
+}
+
+double compute_kernel_rate(void)
+{
+    // Threads run concurrently: their rates add up
+    double rate = 0.0;
+    for (int t = 0; t < MAX_THREADS; t++)
+    {
+        if (slots[t])
+        {
+            rate += slots[t]->busy_time > 0.0 ? slots[t]->work_done / slots[t]->busy_time * 1e-9 : 0.0;
+            slots[t]->work_done = 0.0;
+            slots[t]->busy_time = 0.0;
+        }
+    }
+    return rate;
+}
+
+const char *compute_kernel_unit(ComputeKernel kernel)
+{
+    switch (kernel)
+    {
+    case COMPUTE_KERNEL_STREAM:
+        return "GB/s";
+    case COMPUTE_KERNEL_FMA:
+        return "GFLOP/s";
+    default:
+        return NULL;
+    }
+}
+
+void compute_kernel_release(void)
+{
+    for (int t = 0; t < MAX_THREADS; t++)
+    {
+        if (slots[t])
+        {
+            triad_free(slots[t]);
+        }
+    }
+}
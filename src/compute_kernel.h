@@ -0,0 +1,61 @@
+/**
+ * @file compute_kernel.h
+ * @brief Workloads run by compute() in place of a plain sleep.
+ *
+ * The kernel is selected at runtime with --kernel (see config.h):
+ * - sleep: waits compute_time seconds, the original behaviour.
+ * - stream: STREAM triad a[i] = b[i] + s * c[i] over three work buffers of
+ *   work_size doubles, written so that the compiler vectorizes it. Memory bound;
+ *   the rate is reported in GB/s, counting 24 bytes moved per element.
+ * - fma: work_size iterations of independent multiply-add chains kept in
+ *   registers. Compute bound; the rate is reported in GFLOP/s.
+ *
+ * The work buffers and FMA chains belong to the calling thread, so the threads of
+ * a hybrid rank (hybrid.h) never share them. They are allocated on first use, so
+ * the first iterations after a reconfiguration show the cost of cold caches and
+ * page faults on newly spawned ranks and threads.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef COMPUTE_KERNEL_H
+#define COMPUTE_KERNEL_H
+
+#include "config.h"
+
+/**
+ * @brief Runs one call of the configured kernel.
+ *
+ * @param cfg Runtime configuration (kernel, work_size, compute_time)
+ *
+ * @note Aborts if the work buffers cannot be allocated
+ * @note May be called concurrently by the threads of an OpenMP team; makes no MPI call
+ */
+void compute_kernel_run(const Config *cfg);
+
+/**
+ * @brief Returns the rate achieved since the previous call and restarts the measurement.
+ *
+ * @return Achieved rate in the unit given by compute_kernel_unit(), summed over the
+ *         threads, 0 if nothing ran
+ */
+double compute_kernel_rate(void);
+
+/**
+ * @brief Returns the unit of compute_kernel_rate() for a kernel.
+ *
+ * @param kernel Compute kernel
+ * @return "GB/s", "GFLOP/s", or NULL for kernels that do not report a rate
+ */
+const char *compute_kernel_unit(ComputeKernel kernel);
+
+/**
+ * @brief Frees the work buffers of every thread, if any.
+ *
+ * @note Called outside of parallel regions
+ */
+void compute_kernel_release(void);
+
+#endif /* COMPUTE_KERNEL_H */
@@ -0,0 +1,556 @@
+/**
+ * @file config.c
+ * @brief Implementation of the runtime configuration parser.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "checkpoint_codec.h"
+#include "counter.h"
+
+/** @brief Identifiers of the configurable options */
+typedef enum
+{
+    OPT_COUNTERS = 0,
+    OPT_MAX_VALUE,
+    OPT_COMPUTE_TIME,
+    OPT_CHECKPOINT_DIR,
+    OPT_CHECKPOINT_MODE,
+    OPT_ASYNC_INTERVAL,
+    OPT_DELTA_COMPACT,
+    OPT_RESIZE_STEP,
+    OPT_KERNEL,
+    OPT_WORK_SIZE,
+    OPT_TRACE,
+    OPT_TRACE_FORMAT,
+    OPT_VERBOSITY,
+    OPT_STATUS_INTERVAL,
+    OPT_STEAL_CHUNK,
+    OPT_POLICY,
+    OPT_RECONFIG_COST,
+    OPT_THREADS,
+    OPT_MAX_THREADS,
+    OPT_NODE_DIR,
+    OPT_MMAP_RESTART,
+    OPT_CODEC,
+    OPT_BENCH,
+    OPT_HUGE_PAGES,
+    OPT_PREWARM,
+    OPT_MAPPING,
+    OPT_MTBF,
+    OPT_BUDDY,
+    OPT_METRICS,
+    OPT_METRICS_INTERVAL,
+    OPT_COUNT
+} OptionId;
+
+/** @brief Command line name and environment variable of every option */
+static const struct
+{
+    const char *flag;
+    const char *env;
+} options[OPT_COUNT] = {
+    [OPT_COUNTERS] = {"counters", "DMR_NUM_COUNTERS"},
+    [OPT_MAX_VALUE] = {"max-value", "DMR_MAX_COUNTER_VALUE"},
+    [OPT_COMPUTE_TIME] = {"compute-time", "DMR_COMPUTE_TIME"},
+    [OPT_CHECKPOINT_DIR] = {"checkpoint-dir", "DMR_CHECKPOINT_DIR"},
+    [OPT_CHECKPOINT_MODE] = {"checkpoint-mode", "DMR_CKPT_MODE"},
+    [OPT_ASYNC_INTERVAL] = {"async-interval", "DMR_CKPT_ASYNC_INTERVAL"},
+    [OPT_DELTA_COMPACT] = {"delta-compact", "DMR_CKPT_DELTA_COMPACT"},
+    [OPT_RESIZE_STEP] = {"resize-step", "DMR_RESIZE_STEP"},
+    [OPT_KERNEL] = {"kernel", "DMR_COMPUTE_KERNEL"},
+    [OPT_WORK_SIZE] = {"work-size", "DMR_WORK_SIZE"},
+    [OPT_TRACE] = {"trace", "DMR_TRACE"},
+    [OPT_TRACE_FORMAT] = {"trace-format", "DMR_TRACE_FORMAT"},
+    [OPT_VERBOSITY] = {"verbosity", "DMR_VERBOSITY"},
+    [OPT_STATUS_INTERVAL] = {"status-interval", "DMR_STATUS_INTERVAL"},
+    [OPT_STEAL_CHUNK] = {"steal-chunk", "DMR_STEAL_CHUNK"},
+    [OPT_POLICY] = {"policy", "DMR_RESIZE_POLICY"},
+    [OPT_RECONFIG_COST] = {"reconfig-cost", "DMR_RECONFIG_COST"},
+    [OPT_THREADS] = {"threads", "DMR_THREADS"},
+    [OPT_MAX_THREADS] = {"max-threads", "DMR_MAX_THREADS"},
+    [OPT_NODE_DIR] = {"node-dir", "DMR_NODE_DIR"},
+    [OPT_MMAP_RESTART] = {"mmap-restart", "DMR_MMAP_RESTART"},
+    [OPT_CODEC] = {"codec", "DMR_CKPT_CODEC"},
+    [OPT_BENCH] = {"bench", "DMR_BENCH"},
+    [OPT_HUGE_PAGES] = {"huge-pages", "DMR_HUGE_PAGES"},
+    [OPT_PREWARM] = {"prewarm", "DMR_PREWARM"},
+    [OPT_MAPPING] = {"mapping", "DMR_MAPPING"},
+    [OPT_MTBF] = {"mtbf", "DMR_MTBF"},
+    [OPT_BUDDY] = {"buddy", "DMR_BUDDY"},
+    [OPT_METRICS] = {"metrics", "DMR_METRICS"},
+    [OPT_METRICS_INTERVAL] = {"metrics-interval", "DMR_METRICS_INTERVAL"},
+};
+
+/** @brief Names of the checkpoint modes, indexed by CheckpointMode */
+static const char *mode_names[] = {"text", "mpiio", "binary", "memory", "delta", "node", "compressed"};
+
+/** @brief Names of the compute kernels, indexed by ComputeKernel */
+static const char *kernel_names[] = {"sleep", "stream", "fma"};
+
+/** @brief Names of the trace formats, indexed by TraceFormat */
+static const char *trace_format_names[] = {"json", "chrome"};
+
+/** @brief Names of the resize policies, indexed by ResizePolicy */
+static const char *policy_names[] = {"threshold", "cost", "none"};
+
+/** @brief Names of the checkpoint codecs, indexed by CheckpointCodec */
+static const char *codec_names[] = {"auto", "pack", "rle", "zstd", "lz4"};
+
+/** @brief Names of the rank mappings, indexed by RankMapping */
+static const char *mapping_names[] = {"block", "topology"};
+
+/**
+ * @brief Parses a non-negative count with an optional k/M/G suffix.
+ */
+static int parse_count(const char *value, int64_t max, int64_t *out)
+{
+    errno = 0;
+    char *end;
+    long long parsed = strtoll(value, &end, 10);
+    if (errno != 0 || end == value || parsed < 0)
+    {
+        return -1;
+    }
+
+    int64_t scale = 1;
+    switch (*end)
+    {
+    case 'k':
+    case 'K':
+        scale = 1000;
+        end++;
+        break;
+    case 'M':
+        scale = 1000000;
+        end++;
+        break;
+    case 'G':
+        scale = 1000000000;
+        end++;
+        break;
+    }
+    if (*end != '\0' || parsed > max / scale)
+    {
+        return -1;
+    }
+
+    *out = (int64_t)parsed * scale;
+    return 0;
+}
+
+/**
+ * @brief Applies one option value to the configuration.
+ */
+static int apply_option(Config *cfg, OptionId id, const char *value)
+{
+    int64_t count;
+    char *end;
+
+    switch (id)
+    {
+    case OPT_COUNTERS:
+        if (parse_count(value, INT64_MAX, &count) != 0 || count <= 0)
+        {
+            return -1;
+        }
+        cfg->num_counters = count;
+        return 0;
+    case OPT_MAX_VALUE:
+        if (parse_count(value, COUNTER_MAX, &count) != 0)
+        {
+            return -1;
+        }
+        cfg->max_counter_value = (int)count;
+        return 0;
+    case OPT_COMPUTE_TIME:
+        cfg->compute_time = strtod(value, &end);
+        return (end == value || *end != '\0' || cfg->compute_time < 0) ? -1 : 0;
+    case OPT_CHECKPOINT_DIR:
+        if (strlen(value) == 0 || strlen(value) >= sizeof(cfg->checkpoint_dir) - 1)
+        {
+            return -1;
+        }
+        snprintf(cfg->checkpoint_dir, sizeof(cfg->checkpoint_dir), "%s%s", value, value[strlen(value) - 1] == '/' ? "" : "/");
+        return 0;
+    case OPT_CHECKPOINT_MODE:
+        return checkpoint_mode_parse(value, &cfg->ckpt_mode);
+    case OPT_ASYNC_INTERVAL:
+        if (parse_count(value, INT_MAX, &count) != 0)
+        {
+            return -1;
+        }
+        cfg->ckpt_async_interval = (int)count;
+        return 0;
+    case OPT_DELTA_COMPACT:
+        if (parse_count(value, INT_MAX, &count) != 0 || count == 0)
+        {
+            return -1;
+        }
+        cfg->delta_compact = (int)count;
+        return 0;
+    case OPT_RESIZE_STEP:
+        if (parse_count(value, INT_MAX, &count) != 0 || count == 0)
+        {
+            return -1;
+        }
+        cfg->resize_step = (int)count;
+        return 0;
+    case OPT_KERNEL:
+        return compute_kernel_parse(value, &cfg->kernel);
+    case OPT_WORK_SIZE:
+        if (parse_count(value, INT64_MAX / 64, &count) != 0 || count == 0)
+        {
+            return -1;
+        }
+        cfg->work_size = count;
+        return 0;
+    case OPT_TRACE:
+        if (strlen(value) >= sizeof(cfg->trace_path))
+        {
+            return -1;
+        }
+        snprintf(cfg->trace_path, sizeof(cfg->trace_path), "%s", value);
+        return 0;
+    case OPT_TRACE_FORMAT:
+        for (size_t i = 0; i < sizeof(trace_format_names) / sizeof(trace_format_names[0]); i++)
+        {
+            if (strcmp(value, trace_format_names[i]) == 0)
+            {
+                cfg->trace_format = (TraceFormat)i;
+                return 0;
+            }
+        }
+        return -1;
+    case OPT_VERBOSITY:
+        if (parse_count(value, 2, &count) != 0)
+        {
+            return -1;
+        }
+        cfg->verbosity = (int)count;
+        return 0;
+    case OPT_STATUS_INTERVAL:
+        if (parse_count(value, INT_MAX, &count) != 0 || count == 0)
+        {
+            return -1;
+        }
+        cfg->status_interval = (int)count;
+        return 0;
+    case OPT_STEAL_CHUNK:
+        if (parse_count(value, INT_MAX, &count) != 0)
+        {
+            return -1;
+        }
+        cfg->steal_chunk = (int)count;
+        return 0;
+    case OPT_POLICY:
+        return resize_policy_parse(value, &cfg->policy);
+    case OPT_RECONFIG_COST:
+        cfg->reconfig_cost = strtod(value, &end);
+        return (end == value || *end != '\0' || cfg->reconfig_cost < 0) ? -1 : 0;
+    case OPT_THREADS:
+        if (parse_count(value, MAX_THREADS, &count) != 0 || count == 0)
+        {
+            return -1;
+        }
+        cfg->threads = (int)count;
+        return 0;
+    case OPT_MAX_THREADS:
+        if (parse_count(value, MAX_THREADS, &count) != 0 || count == 0)
+        {
+            return -1;
+        }
+        cfg->max_threads = (int)count;
+        return 0;
+    case OPT_NODE_DIR:
+        if (strlen(value) == 0 || strlen(value) >= sizeof(cfg->node_dir) - 1)
+        {
+            return -1;
+        }
+        snprintf(cfg->node_dir, sizeof(cfg->node_dir), "%s%s", value, value[strlen(value) - 1] == '/' ? "" : "/");
+        return 0;
+    case OPT_MMAP_RESTART:
+        if (parse_count(value, 1, &count) != 0)
+        {
+            return -1;
+        }
+        cfg->mmap_restart = (int)count;
+        return 0;
+    case OPT_CODEC:
+        return checkpoint_codec_parse(value, &cfg->codec);
+    case OPT_BENCH:
+        if (strlen(value) >= sizeof(cfg->bench_path))
+        {
+            return -1;
+        }
+        snprintf(cfg->bench_path, sizeof(cfg->bench_path), "%s", value);
+        return 0;
+    case OPT_HUGE_PAGES:
+        if (parse_count(value, 1, &count) != 0)
+        {
+            return -1;
+        }
+        cfg->huge_pages = (int)count;
+        return 0;
+    case OPT_PREWARM:
+        if (parse_count(value, INT_MAX, &count) != 0)
+        {
+            return -1;
+        }
+        cfg->prewarm = (int)count;
+        return 0;
+    case OPT_MAPPING:
+        for (size_t i = 0; i < sizeof(mapping_names) / sizeof(mapping_names[0]); i++)
+        {
+            if (strcmp(value, mapping_names[i]) == 0)
+            {
+                cfg->mapping = (RankMapping)i;
+                return 0;
+            }
+        }
+        return -1;
+    case OPT_MTBF:
+        cfg->mtbf = strtod(value, &end);
+        return (end == value || *end != '\0' || cfg->mtbf < 0) ? -1 : 0;
+    case OPT_BUDDY:
+        if (parse_count(value, 1, &count) != 0)
+        {
+            return -1;
+        }
+        cfg->buddy = (int)count;
+        return 0;
+    case OPT_METRICS:
+        if (strlen(value) >= sizeof(cfg->metrics_path))
+        {
+            return -1;
+        }
+        snprintf(cfg->metrics_path, sizeof(cfg->metrics_path), "%s", value);
+        return 0;
+    case OPT_METRICS_INTERVAL:
+        cfg->metrics_interval = strtod(value, &end);
+        return (end == value || *end != '\0' || cfg->metrics_interval <= 0) ? -1 : 0;
+    default:
+        return -1;
+    }
+}
+
+int config_init(Config *cfg, int argc, char **argv)
+{
+    // Built-in defaults
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->num_counters = DEFAULT_NUM_COUNTERS;
+    cfg->max_counter_value = DEFAULT_MAX_COUNTER_VALUE;
+    cfg->compute_time = DEFAULT_COMPUTE_TIME;
+    snprintf(cfg->checkpoint_dir, sizeof(cfg->checkpoint_dir), "%s", DEFAULT_FILEPATH);
+    snprintf(cfg->node_dir, sizeof(cfg->node_dir), "%s", DEFAULT_NODE_DIR);
+    cfg->ckpt_mode = CKPT_MODE_TEXT;
+    cfg->ckpt_async_interval = 0;
+    cfg->delta_compact = DEFAULT_DELTA_COMPACT;
+    cfg->resize_step = DEFAULT_RESIZE_STEP;
+    cfg->kernel = COMPUTE_KERNEL_SLEEP;
+    cfg->work_size = DEFAULT_WORK_SIZE;
+    cfg->trace_format = TRACE_FORMAT_JSON;
+    cfg->verbosity = 1;
+    cfg->status_interval = DEFAULT_STATUS_INTERVAL;
+    cfg->policy = RESIZE_POLICY_THRESHOLD;
+    cfg->reconfig_cost = DEFAULT_RECONFIG_COST;
+    cfg->threads = 1;
+    cfg->mmap_restart = 0;
+    cfg->codec = CKPT_CODEC_AUTO;
+    cfg->huge_pages = 0;
+    cfg->prewarm = 0;
+    cfg->mapping = RANK_MAPPING_BLOCK;
+    cfg->mtbf = 0.0;
+    cfg->buddy = 0;
+    cfg->metrics_interval = DEFAULT_METRICS_INTERVAL;
+
+    // Environment overrides defaults
+    for (int id = 0; id < OPT_COUNT; id++)
+    {
+        const char *value = getenv(options[id].env);
+        if (value && apply_option(cfg, id, value) != 0)
+        {
+            fprintf(stderr, "Invalid value '%s' for %s\n", value, options[id].env);
+            return -1;
+        }
+    }
+
+    // Command line overrides environment: --name=value or --name value
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--", 2) != 0)
+        {
+            continue;
+        }
+        for (int id = 0; id < OPT_COUNT; id++)
+        {
+            size_t length = strlen(options[id].flag);
+            if (strncmp(argv[i] + 2, options[id].flag, length) != 0)
+            {
+                continue;
+            }
+
+            const char *value = NULL;
+            if (argv[i][2 + length] == '=')
+            {
+                value = argv[i] + 3 + length;
+            }
+            else if (argv[i][2 + length] == '\0' && i + 1 < argc)
+            {
+                value = argv[++i];
+            }
+            else
+            {
+                continue;
+            }
+
+            if (apply_option(cfg, id, value) != 0)
+            {
+                fprintf(stderr, "Invalid value '%s' for --%s\n", value, options[id].flag);
+                return -1;
+            }
+            break;
+        }
+    }
+
+    // Without a ceiling the thread count stays fixed
+    if (cfg->max_threads == 0)
+    {
+        cfg->max_threads = cfg->threads;
+    }
+    if (cfg->max_threads < cfg->threads)
+    {
+        fprintf(stderr, "--max-threads (%d) is lower than --threads (%d)\n", cfg->max_threads, cfg->threads);
+        return -1;
+    }
+
+    // The general-purpose backends are optional build dependencies
+    if (!ckpt_codec_available(cfg->codec))
+    {
+        fprintf(stderr, "Codec %s is not built in (rebuild with make %s=1)\n", checkpoint_codec_name(cfg->codec),
+                cfg->codec == CKPT_CODEC_ZSTD ? "ZSTD" : "LZ4");
+        return -1;
+    }
+
+    snprintf(cfg->filepath, sizeof(cfg->filepath), "%s%s", cfg->checkpoint_dir, FILENAME);
+    return 0;
+}
+
+void config_print(const Config *cfg)
+{
+    printf("Configuration: counters=%lld max-value=%d compute-time=%g checkpoint=%s mode=%s "
+           "async-interval=%d delta-compact=%d resize-step=%d kernel=%s work-size=%lld trace=%s verbosity=%d status-interval=%d steal-chunk=%d policy=%s reconfig-cost=%g threads=%d max-threads=%d node-dir=%s mmap-restart=%d codec=%s bench=%s huge-pages=%d prewarm=%d mapping=%s mtbf=%g buddy=%d metrics=%s metrics-interval=%g\n",
+           (long long)cfg->num_counters, cfg->max_counter_value, cfg->compute_time, cfg->filepath,
+           checkpoint_mode_name(cfg->ckpt_mode), cfg->ckpt_async_interval, cfg->delta_compact, cfg->resize_step,
+           compute_kernel_name(cfg->kernel), (long long)cfg->work_size,
+           cfg->trace_path[0] ? trace_format_names[cfg->trace_format] : "off",
+           cfg->verbosity, cfg->status_interval, cfg->steal_chunk, resize_policy_name(cfg->policy), cfg->reconfig_cost,
+           cfg->threads, cfg->max_threads, cfg->node_dir, cfg->mmap_restart,
+           checkpoint_codec_name(cfg->codec), cfg->bench_path[0] ? cfg->bench_path : "off", cfg->huge_pages, cfg->prewarm, rank_mapping_name(cfg->mapping), cfg->mtbf, cfg->buddy, cfg->metrics_path[0] ? cfg->metrics_path : "off", cfg->metrics_interval);
+}
+
+int checkpoint_mode_parse(const char *name, CheckpointMode *mode)
+{
+    for (size_t i = 0; i < sizeof(mode_names) / sizeof(mode_names[0]); i++)
+    {
+        if (strcmp(name, mode_names[i]) == 0)
+        {
+            *mode = (CheckpointMode)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *checkpoint_mode_name(CheckpointMode mode)
+{
+    if ((size_t)mode >= sizeof(mode_names) / sizeof(mode_names[0]))
+    {
+        return "unknown";
+    }
+    return mode_names[mode];
+}
+
+int compute_kernel_parse(const char *name, ComputeKernel *kernel)
+{
+    for (size_t i = 0; i < sizeof(kernel_names) / sizeof(kernel_names[0]); i++)
+    {
+        if (strcmp(name, kernel_names[i]) == 0)
+        {
+            *kernel = (ComputeKernel)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *compute_kernel_name(ComputeKernel kernel)
+{
+    if ((size_t)kernel >= sizeof(kernel_names) / sizeof(kernel_names[0]))
+    {
+        return "unknown";
+    }
+    return kernel_names[kernel];
+}
+
+int resize_policy_parse(const char *name, ResizePolicy *policy)
+{
+    for (size_t i = 0; i < sizeof(policy_names) / sizeof(policy_names[0]); i++)
+    {
+        if (strcmp(name, policy_names[i]) == 0)
+        {
+            *policy = (ResizePolicy)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *resize_policy_name(ResizePolicy policy)
+{
+    if ((size_t)policy >= sizeof(policy_names) / sizeof(policy_names[0]))
+    {
+        return "unknown";
+    }
+    return policy_names[policy];
+}
+
+int checkpoint_codec_parse(const char *name, CheckpointCodec *codec)
+{
+    for (size_t i = 0; i < sizeof(codec_names) / sizeof(codec_names[0]); i++)
+    {
+        if (strcmp(name, codec_names[i]) == 0)
+        {
+            *codec = (CheckpointCodec)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *checkpoint_codec_name(CheckpointCodec codec)
+{
+    if ((size_t)codec >= sizeof(codec_names) / sizeof(codec_names[0]))
+    {
+        return "unknown";
+    }
+    return codec_names[codec];
+}
+
+const char *rank_mapping_name(RankMapping mapping)
+{
+    if ((size_t)mapping >= sizeof(mapping_names) / sizeof(mapping_names[0]))
+    {
+        return "unknown";
+    }
+    return mapping_names[mapping];
+}
@@ -0,0 +1,279 @@
+/**
+ * @file config.h
+ * @brief Runtime configuration of the distributed counter simulation.
+ *
+ * Every tunable of the simulation lives in a Config structure that is filled
+ * once at startup, from built-in defaults, then environment variables, then
+ * command line options (later sources override earlier ones):
+ *
+ * | Option              | Environment variable     | Default        |
+ * |---------------------|--------------------------|----------------|
+ * | --counters=N        | DMR_NUM_COUNTERS         | 50             |
+ * | --max-value=N       | DMR_MAX_COUNTER_VALUE    | 10             |
+ * | --compute-time=S    | DMR_COMPUTE_TIME         | 2 (seconds)    |
+ * | --checkpoint-dir=D  | DMR_CHECKPOINT_DIR       | checkpoints/   |
+ * | --checkpoint-mode=M | DMR_CKPT_MODE            | text           |
+ * | --async-interval=N  | DMR_CKPT_ASYNC_INTERVAL  | 0 (disabled)   |
+ * | --delta-compact=N   | DMR_CKPT_DELTA_COMPACT   | 8              |
+ * | --resize-step=N     | DMR_RESIZE_STEP          | 2              |
+ * | --kernel=K          | DMR_COMPUTE_KERNEL       | sleep          |
+ * | --work-size=N       | DMR_WORK_SIZE            | 65536          |
+ * | --trace=F           | DMR_TRACE                | none (off)     |
+ * | --trace-format=T    | DMR_TRACE_FORMAT         | json           |
+ * | --verbosity=N       | DMR_VERBOSITY            | 1              |
+ * | --status-interval=N | DMR_STATUS_INTERVAL      | 10             |
+ * | --steal-chunk=N     | DMR_STEAL_CHUNK          | 0 (static)     |
+ * | --policy=P          | DMR_RESIZE_POLICY        | threshold      |
+ * | --reconfig-cost=S   | DMR_RECONFIG_COST        | 1 (seconds)    |
+ * | --threads=N         | DMR_THREADS              | 1              |
+ * | --max-threads=N     | DMR_MAX_THREADS          | --threads      |
+ * | --node-dir=D        | DMR_NODE_DIR             | /dev/shm/      |
+ * | --mmap-restart=B    | DMR_MMAP_RESTART         | 0 (read)       |
+ * | --codec=C           | DMR_CKPT_CODEC           | auto           |
+ * | --bench=F           | DMR_BENCH                | none (off)     |
+ * | --huge-pages=B      | DMR_HUGE_PAGES           | 0 (off)        |
+ * | --prewarm=N         | DMR_PREWARM              | 0 (off)        |
+ * | --mapping=M         | DMR_MAPPING              | block          |
+ * | --mtbf=S            | DMR_MTBF                 | 0 (off)        |
+ * | --buddy=B           | DMR_BUDDY                | 0 (off)        |
+ * | --metrics=F         | DMR_METRICS              | none (off)     |
+ * | --metrics-interval=S | DMR_METRICS_INTERVAL    | 1 (seconds)    |
+ *
+ * Counts accept a k, M or G suffix (powers of 1000), e.g. --counters=500M.
+ * --max-value may not exceed the largest counter of the build (see counter.h).
+ * Unknown command line arguments are ignored, so they can be left to DMR.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stdint.h>
+
+/** @brief Default directory path for checkpoint files */
+#define DEFAULT_FILEPATH "checkpoints/"
+/** @brief Default node-local directory of the node checkpoint tier (tmpfs) */
+#define DEFAULT_NODE_DIR "/dev/shm/"
+/** @brief Base filename for counter checkpoint files */
+#define FILENAME "counters"
+/** @brief Default total number of counters distributed across all MPI ranks */
+#define DEFAULT_NUM_COUNTERS 50
+/** @brief Default maximum value each counter can reach before stopping */
+#define DEFAULT_MAX_COUNTER_VALUE 10
+/** @brief Default simulated computation time in seconds per counter increment */
+#define DEFAULT_COMPUTE_TIME 2
+/** @brief Default number of processes added or removed by each expand/shrink */
+#define DEFAULT_RESIZE_STEP 2
+/** @brief Default number of deltas between two full bases */
+#define DEFAULT_DELTA_COMPACT 8
+/** @brief Default number of work elements processed by each compute() call */
+#define DEFAULT_WORK_SIZE 65536
+/** @brief Default number of iterations between two status reports */
+#define DEFAULT_STATUS_INTERVAL 10
+/** @brief Default estimate in seconds of one reconfiguration, before any is measured */
+#define DEFAULT_RECONFIG_COST 1.0
+/** @brief Default number of seconds between two live metrics snapshots */
+#define DEFAULT_METRICS_INTERVAL 1.0
+/** @brief Largest number of threads per rank */
+#define MAX_THREADS 256
+
+/**
+ * @brief Strategy used by checkpoint() to build the global checkpoint file.
+ */
+typedef enum
+{
+    CKPT_MODE_TEXT = 0,   /**< Text file written by one leader per node (default) */
+    CKPT_MODE_MPIIO,      /**< Collective MPI-IO write of every slice into one shared file */
+    CKPT_MODE_BINARY,     /**< Collective MPI-IO write of the binary format (checkpoint_format.h) */
+    CKPT_MODE_MEMORY,     /**< No file: counters move between processes in memory (redistribute.h) */
+    CKPT_MODE_DELTA,      /**< Binary base plus incremental deltas of changed counters (delta_checkpoint.h) */
+    CKPT_MODE_NODE,       /**< Node-local files, drained to the binary file by node leaders (node_tier.h) */
+    CKPT_MODE_COMPRESSED  /**< Collective MPI-IO write of compressed blocks with an index (compressed_checkpoint.h) */
+} CheckpointMode;
+
+/**
+ * @brief Encoding of the blocks of a compressed checkpoint (see checkpoint_codec.h).
+ */
+typedef enum
+{
+    CKPT_CODEC_AUTO = 0, /**< Smaller of bit-packing and run-length encoding, per block (default) */
+    CKPT_CODEC_PACK,     /**< Bit-packing to the width of max_counter_value */
+    CKPT_CODEC_RLE,      /**< Runs of equal values, e.g. saturated counters */
+    CKPT_CODEC_ZSTD,     /**< auto, then zstd (built with make ZSTD=1) */
+    CKPT_CODEC_LZ4       /**< auto, then LZ4 (built with make LZ4=1) */
+} CheckpointCodec;
+
+/**
+ * @brief Workload run by compute() for every counter increment (see compute_kernel.h).
+ */
+typedef enum
+{
+    COMPUTE_KERNEL_SLEEP = 0, /**< Sleep for compute_time seconds, no CPU load (default) */
+    COMPUTE_KERNEL_STREAM,    /**< Memory-bound STREAM triad over the work buffer, reports GB/s */
+    COMPUTE_KERNEL_FMA        /**< Compute-bound chains of multiply-adds, reports GFLOP/s */
+} ComputeKernel;
+
+/**
+ * @brief Layout of the per-process trace files (see trace.h).
+ */
+typedef enum
+{
+    TRACE_FORMAT_JSON = 0, /**< One JSON object per line (default) */
+    TRACE_FORMAT_CHROME    /**< Chrome trace event format, for chrome://tracing or Perfetto */
+} TraceFormat;
+
+/**
+ * @brief Policy deciding when and by how much to resize (see resize_policy.h).
+ */
+typedef enum
+{
+    RESIZE_POLICY_THRESHOLD = 0, /**< Fixed counter value triggers plus idle-rank shrinks (default) */
+    RESIZE_POLICY_COST,          /**< Cost model of reconfiguration overhead against projected savings */
+    RESIZE_POLICY_NONE           /**< Never resize, the baseline for comparisons */
+} ResizePolicy;
+
+/**
+ * @brief Assignment of the counter slices to the ranks of a new layout (see topology.h).
+ */
+typedef enum
+{
+    RANK_MAPPING_BLOCK = 0, /**< Slice i to rank i (default) */
+    RANK_MAPPING_TOPOLOGY   /**< Slices to the ranks on the nodes already holding their counters */
+} RankMapping;
+
+/**
+ * @brief Runtime configuration shared by every stage of the simulation.
+ */
+typedef struct
+{
+    int64_t num_counters;     /**< Total number of counters across all ranks */
+    int max_counter_value;    /**< Value at which a counter stops being incremented */
+    double compute_time;      /**< Simulated computation time in seconds per counter */
+    char checkpoint_dir[448]; /**< Directory holding the checkpoint files */
+    char filepath[512];       /**< Full path of the global checkpoint file */
+    CheckpointMode ckpt_mode; /**< Checkpoint strategy used on reconfiguration */
+    int ckpt_async_interval;  /**< Iterations between asynchronous checkpoints, 0 disables them */
+    int delta_compact;        /**< Deltas written between two full bases in CKPT_MODE_DELTA */
+    int resize_step;          /**< Processes added or removed by each expand/shrink */
+    ComputeKernel kernel;     /**< Workload run by compute() */
+    int64_t work_size;        /**< Elements (stream) or iterations (fma) per compute() call */
+    char trace_path[448];     /**< Prefix of the per-process trace files, empty disables tracing */
+    TraceFormat trace_format; /**< Layout of the trace files */
+    int verbosity;            /**< 0 quiet, 1 rank 0 summary, 2 summary plus per-rank logs */
+    int status_interval;      /**< Iterations between two status reports */
+    int steal_chunk;          /**< Counters per work-stealing chunk, 0 keeps the static split */
+    ResizePolicy policy;      /**< Policy deciding expand/shrink requests */
+    double reconfig_cost;     /**< Initial estimate in seconds of one reconfiguration */
+    int threads;              /**< Threads per rank running the counter loop */
+    int max_threads;          /**< Threads a rank may grow to before DMR spawns processes */
+    char node_dir[256];       /**< Node-local directory of the node checkpoint tier */
+    int mmap_restart;         /**< 1 maps binary checkpoint slices copy-on-write on restart instead of reading them */
+    CheckpointCodec codec;    /**< Block encoding of CKPT_MODE_COMPRESSED */
+    char bench_path[448];     /**< CSV file the benchmark rows are appended to, empty disables them */
+    int huge_pages;           /**< 1 backs the counters and staging buffers with 2 MB huge pages */
+    int prewarm;              /**< Iterations ahead of a forecast expand to prepare its buffers, 0 disables it */
+    RankMapping mapping;      /**< Assignment of the slices to the ranks after a resize */
+    double mtbf;              /**< Mean time between failures in seconds for the checkpoint schedule, 0 disables it */
+    int buddy;                /**< 1 mirrors every slice to a buddy rank and recovers from process failures */
+    char metrics_path[448];   /**< Status file rank 0 publishes live metrics in, empty disables it */
+    double metrics_interval;  /**< Seconds between two metrics snapshots */
+} Config;
+
+/**
+ * @brief Fills a configuration from defaults, environment and command line.
+ *
+ * @param cfg Configuration to fill
+ * @param argc Number of command line arguments
+ * @param argv Command line arguments
+ * @return 0 on success, -1 if a value is malformed or out of range (a message
+ *         describing the problem is printed on stderr)
+ */
+int config_init(Config *cfg, int argc, char **argv);
+
+/**
+ * @brief Prints the configuration on a single line.
+ *
+ * @param cfg Configuration to print
+ */
+void config_print(const Config *cfg);
+
+/**
+ * @brief Parses a checkpoint mode name ("text", "mpiio", "binary", "memory", "delta", "node", "compressed").
+ *
+ * @param name Mode name
+ * @param mode Output mode, left untouched on error
+ * @return 0 on success, -1 for an unknown name
+ */
+int checkpoint_mode_parse(const char *name, CheckpointMode *mode);
+
+/**
+ * @brief Returns the name of a checkpoint mode, as accepted by checkpoint_mode_parse().
+ *
+ * @param mode Checkpoint mode
+ * @return Mode name
+ */
+const char *checkpoint_mode_name(CheckpointMode mode);
+
+/**
+ * @brief Parses a compute kernel name ("sleep", "stream", "fma").
+ *
+ * @param name Kernel name
+ * @param kernel Output kernel, left untouched on error
+ * @return 0 on success, -1 for an unknown name
+ */
+int compute_kernel_parse(const char *name, ComputeKernel *kernel);
+
+/**
+ * @brief Returns the name of a compute kernel, as accepted by compute_kernel_parse().
+ *
+ * @param kernel Compute kernel
+ * @return Kernel name
+ */
+const char *compute_kernel_name(ComputeKernel kernel);
+
+/**
+ * @brief Parses a resize policy name ("threshold", "cost", "none").
+ *
+ * @param name Policy name
+ * @param policy Output policy, left untouched on error
+ * @return 0 on success, -1 for an unknown name
+ */
+int resize_policy_parse(const char *name, ResizePolicy *policy);
+
+/**
+ * @brief Returns the name of a resize policy, as accepted by resize_policy_parse().
+ *
+ * @param policy Resize policy
+ * @return Policy name
+ */
+const char *resize_policy_name(ResizePolicy policy);
+
+/**
+ * @brief Parses a checkpoint codec name ("auto", "pack", "rle", "zstd", "lz4").
+ *
+ * @param name Codec name
+ * @param codec Output codec, left untouched on error
+ * @return 0 on success, -1 for an unknown name
+ */
+int checkpoint_codec_parse(const char *name, CheckpointCodec *codec);
+
+/**
+ * @brief Returns the name of a checkpoint codec, as accepted by checkpoint_codec_parse().
+ *
+ * @param codec Checkpoint codec
+ * @return Codec name
+ */
+const char *checkpoint_codec_name(CheckpointCodec codec);
+
+/**
+ * @brief Returns the name of a rank mapping ("block", "topology").
+ *
+ * @param mapping Rank mapping
+ * @return Mapping name
+ */
+const char *rank_mapping_name(RankMapping mapping);
+
+#endif /* CONFIG_H */
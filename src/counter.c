@@ -0,0 +1,94 @@
+/**
+ * @file counter.c
+ * @brief Implementation of the counter conversions.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <string.h>
+
+#include "counter.h"
+#include "arena.h"
+
+void counter_widen(int32_t *dst, const counter_t *src, int64_t count)
+{
+#if COUNTER_IS_INT32
+    memcpy(dst, src, (size_t)count * sizeof(int32_t));
+#else
+    for (int64_t i = 0; i < count; i++)
+    {
+        dst[i] = src[i];
+    }
+#endif
+}
+
+int counter_narrow(counter_t *dst, const int32_t *src, int64_t count)
+{
+#if COUNTER_IS_INT32
+    memcpy(dst, src, (size_t)count * sizeof(int32_t));
+    return 0;
+#else
+    // Branch-free, so the loop vectorizes; out-of-range values are only reported
+    uint32_t outside = 0;
+    for (int64_t i = 0; i < count; i++)
+    {
+        outside |= (uint32_t)src[i] > COUNTER_MAX;
+        dst[i] = (counter_t)src[i];
+    }
+    return outside ? -1 : 0;
+#endif
+}
+
+uint64_t counter_checksum(const counter_t *values, uint64_t first_index, uint64_t count)
+{
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < count; i++)
+    {
+        // Same weights as ckpt_checksum(), so both agree on the same values
+        sum += (first_index + i + 1) * (uint64_t)(uint32_t)values[i];
+    }
+    return sum;
+}
+
+const int32_t *counter_view(const counter_t *counters, int64_t count)
+{
+#if COUNTER_IS_INT32
+    (void)count;
+    return counters;
+#else
+    int32_t *view = arena_acquire((size_t)(count > 0 ? count : 1) * sizeof(int32_t));
+    counter_widen(view, counters, count);
+    return view;
+#endif
+}
+
+void counter_view_release(const int32_t *view, const counter_t *counters)
+{
+    if ((const void *)view != (const void *)counters)
+    {
+        arena_release((void *)view);
+    }
+}
+
+int32_t *counter_stage(counter_t *counters, int64_t count)
+{
+#if COUNTER_IS_INT32
+    (void)count;
+    return counters;
+#else
+    return arena_acquire((size_t)(count > 0 ? count : 1) * sizeof(int32_t));
+#endif
+}
+
+int counter_stage_commit(counter_t *counters, int32_t *staged, int64_t count)
+{
+    if ((void *)staged == (void *)counters)
+    {
+        return 0;
+    }
+    int status = counter_narrow(counters, staged, count);
+    arena_release(staged);
+    return status;
+}
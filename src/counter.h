@@ -0,0 +1,121 @@
+/**
+ * @file counter.h
+ * @brief Storage type of the counters, selected at compile time.
+ *
+ * Counters never exceed cfg->max_counter_value, which is 10 by default, so
+ * 32 bits per counter waste most of the memory of a slice and of every copy
+ * of it: the in-memory stash, MPI transfers and work-stealing windows. The
+ * build picks the width with COUNTER_BITS (make COUNTER_BITS=8, 16 or 32,
+ * default 32) and config_init() rejects a --max-value that does not fit.
+ *
+ * The checkpoint files keep their int32 values whatever the width (see
+ * checkpoint_format.h), so checkpoints written by builds of different widths
+ * are interchangeable. The helpers below convert at the I/O boundary; with 32
+ * bit counters they hand back the counters array itself and copy nothing.
+ * Narrow counters cannot be mapped from a binary checkpoint, so
+ * --mmap-restart reads the slice instead.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef COUNTER_H
+#define COUNTER_H
+
+#include <mpi.h>
+#include <stdint.h>
+
+#ifndef COUNTER_BITS
+#define COUNTER_BITS 32
+#endif
+
+#if COUNTER_BITS == 8
+typedef uint8_t counter_t;
+#define MPI_COUNTER MPI_UINT8_T
+#define COUNTER_MAX UINT8_MAX
+#elif COUNTER_BITS == 16
+typedef uint16_t counter_t;
+#define MPI_COUNTER MPI_UINT16_T
+#define COUNTER_MAX UINT16_MAX
+#elif COUNTER_BITS == 32
+typedef int32_t counter_t;
+#define MPI_COUNTER MPI_INT32_T
+#define COUNTER_MAX INT32_MAX
+#else
+#error "COUNTER_BITS must be 8, 16 or 32"
+#endif
+
+/** @brief 1 when counters are stored as the int32 values of the checkpoint files */
+#define COUNTER_IS_INT32 (COUNTER_BITS == 32)
+
+/**
+ * @brief Copies counters into int32 values.
+ *
+ * @param dst Output values
+ * @param src Counters
+ * @param count Number of counters
+ */
+void counter_widen(int32_t *dst, const counter_t *src, int64_t count);
+
+/**
+ * @brief Copies int32 values into counters.
+ *
+ * @param dst Output counters
+ * @param src Values
+ * @param count Number of values
+ * @return 0 on success, -1 if a value does not fit a counter (the counters are then undefined)
+ */
+int counter_narrow(counter_t *dst, const int32_t *src, int64_t count);
+
+/**
+ * @brief Weighted checksum of counters, equal to ckpt_checksum() of their int32 values.
+ *
+ * @param values Counters
+ * @param first_index Global index of values[0]
+ * @param count Number of counters
+ * @return Checksum
+ */
+uint64_t counter_checksum(const counter_t *values, uint64_t first_index, uint64_t count);
+
+/**
+ * @brief Returns the counters as int32 values, to write them to a checkpoint file.
+ *
+ * @param counters Counters
+ * @param count Number of counters
+ * @return counters itself with 32 bit counters, a widened copy in an arena buffer otherwise
+ *
+ * @note Release with counter_view_release()
+ */
+const int32_t *counter_view(const counter_t *counters, int64_t count);
+
+/**
+ * @brief Releases a view returned by counter_view().
+ *
+ * @param view View to release
+ * @param counters Counters the view was taken of
+ */
+void counter_view_release(const int32_t *view, const counter_t *counters);
+
+/**
+ * @brief Returns a buffer to read int32 values of counters into.
+ *
+ * @param counters Counters the values are meant for
+ * @param count Number of values
+ * @return counters itself with 32 bit counters, an arena buffer otherwise
+ *
+ * @note Finish with counter_stage_commit()
+ */
+int32_t *counter_stage(counter_t *counters, int64_t count);
+
+/**
+ * @brief Stores the values read into a buffer of counter_stage() and releases it.
+ *
+ * @param counters Counters given to counter_stage()
+ * @param staged Buffer returned by counter_stage()
+ * @param count Number of values to store
+ * @return 0 on success, -1 if a value does not fit a counter
+ */
+int counter_stage_commit(counter_t *counters, int32_t *staged, int64_t count);
+
+#endif /* COUNTER_H */
@@ -0,0 +1,68 @@
+/**
+ * @file counter_map.c
+ * @brief Implementation of the copy-on-write checkpoint slice mapping.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "checkpoint_format.h"
+#include "counter_map.h"
+
+/** @brief Current mapping: page-aligned base and length, and the counters inside it */
+static struct
+{
+    void *base;
+    size_t length;
+    counter_t *counters;
+} map;
+
+counter_t *counter_map_slice(int fd, int64_t first, int64_t num_counters)
+{
+    off_t start = CKPT_HEADER_SIZE + (off_t)first * (off_t)sizeof(int32_t);
+    size_t bytes = (size_t)num_counters * sizeof(int32_t);
+
+    // Touching a mapped page past the end of the file raises SIGBUS
+    struct stat st;
+    if (!COUNTER_IS_INT32 || map.base || num_counters <= 0 || fstat(fd, &st) != 0 || st.st_size < start + (off_t)bytes)
+    {
+        return NULL;
+    }
+
+    // The offset of a mapping must be a multiple of the page size
+    long page = sysconf(_SC_PAGESIZE);
+    off_t aligned = start - start % page;
+    size_t length = (size_t)(start - aligned) + bytes;
+    void *base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, aligned);
+    if (base == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    // The checksum pass reads the whole slice right away
+    madvise(base, length, MADV_WILLNEED);
+
+    map.base = base;
+    map.length = length;
+    map.counters = (counter_t *)((char *)base + (start - aligned));
+    return map.counters;
+}
+
+int counter_map_release(counter_t *counters)
+{
+    if (!map.base || counters != map.counters)
+    {
+        return 0;
+    }
+
+    munmap(map.base, map.length);
+    map.base = NULL;
+    map.length = 0;
+    map.counters = NULL;
+    return 1;
+}
@@ -0,0 +1,52 @@
+/**
+ * @file counter_map.h
+ * @brief Copy-on-write mapping of a rank's slice of the binary checkpoint.
+ *
+ * With --mmap-restart, restart() does not read its slice of a binary global
+ * checkpoint into the counters array: it maps the slice with MAP_PRIVATE and
+ * uses the mapping as the counters array. Until a counter is incremented, its
+ * page is the page cache page of the file, so no copy is made and the page
+ * does not count as private memory; the first increment of any of its
+ * counters copies that page only. Near completion most counters are finished
+ * and never written again, so most of the slice is never copied.
+ *
+ * The mapping stays valid across later checkpoints: they are written to a
+ * staged file and renamed over the mapped one (see checkpoint_commit.h), so
+ * the mapped inode is never written again and lives on until it is unmapped.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef COUNTER_MAP_H
+#define COUNTER_MAP_H
+
+#include <stdint.h>
+
+#include "counter.h"
+
+/**
+ * @brief Maps num_counters int32 values of a binary checkpoint, starting at counter first.
+ *
+ * @param fd File descriptor of the binary checkpoint, open for reading
+ * @param first Global index of the first mapped counter
+ * @param num_counters Number of counters to map
+ * @return Counters array backed by the file, or NULL if the file is too short,
+ *         cannot be mapped or counters are narrower than the int32 values of the
+ *         file (the caller reads the slice instead)
+ *
+ * @note At most one slice is mapped at a time; the descriptor may be closed afterwards
+ */
+counter_t *counter_map_slice(int fd, int64_t first, int64_t num_counters);
+
+/**
+ * @brief Unmaps counters if they are the mapped slice.
+ *
+ * @param counters Counters array
+ * @return 1 if counters was the mapped slice and is released, 0 otherwise
+ *         (the array was allocated with malloc and is left untouched)
+ */
+int counter_map_release(counter_t *counters);
+
+#endif /* COUNTER_MAP_H */
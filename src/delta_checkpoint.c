@@ -0,0 +1,380 @@
+/**
+ * @file delta_checkpoint.c
+ * @brief Implementation of incremental (delta) checkpoints.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+
+#include "test.h"
+#include "delta_checkpoint.h"
+#include "buddy.h"
+
+uint64_t *delta_dirty = NULL;
+
+/** @brief Words in the dirty bitmap of the local slice */
+static int64_t dirty_words = 0;
+
+/** @brief Base the next delta applies to, and number of deltas already on top of it */
+static struct
+{
+    int have_base;
+    uint64_t base_epoch;
+    int seq;
+} delta = {0, 0, 0};
+
+/** @brief Suffix of the file a delta is written to before it is renamed into place */
+#define DELTA_STAGED_SUFFIX ".tmp"
+
+/**
+ * @brief Builds the name of the delta file with the given sequence number.
+ */
+static void delta_path(char *buffer, size_t length, const char *filepath, int seq)
+{
+    snprintf(buffer, length, "%s.delta.%d", filepath, seq);
+}
+
+/**
+ * @brief Renames a staged delta into place once every rank has closed it.
+ *
+ * A crash before the rename leaves the chain one delta shorter; delta_replay()
+ * never sees a partially written file.
+ */
+static void commit_delta(MPI_Comm comm, int rank, const char *staged, const char *path, const Config *cfg)
+{
+    MPI_Barrier(comm);
+
+    int ok = 1;
+    if (rank == 0)
+    {
+        if (rename(staged, path) != 0)
+        {
+            fprintf(stderr, "Failed to commit delta %s: %s\n", path, strerror(errno));
+            ok = 0;
+        }
+        else
+        {
+            // The rename is only durable once the directory itself is on disk
+            int fd = open(cfg->checkpoint_dir, O_RDONLY | O_DIRECTORY);
+            if (fd >= 0)
+            {
+                fsync(fd);
+                close(fd);
+            }
+        }
+    }
+    MPI_Bcast(&ok, 1, MPI_INT, 0, comm);
+    if (!ok)
+    {
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+}
+
+void delta_track_reset(int64_t num_counters)
+{
+    free(delta_dirty);
+    dirty_words = (num_counters + 63) / 64;
+    delta_dirty = calloc(dirty_words > 0 ? dirty_words : 1, sizeof(uint64_t));
+    if (!delta_dirty)
+    {
+        fprintf(stderr, "Memory allocation failed for dirty bitmap\n");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+}
+
+void delta_mark_all(void)
+{
+    // Bits past the end of the slice are never read
+    if (delta_dirty)
+    {
+        memset(delta_dirty, 0xFF, dirty_words * sizeof(uint64_t));
+    }
+}
+
+void delta_rebase(uint64_t base_epoch)
+{
+    if (delta_dirty)
+    {
+        memset(delta_dirty, 0, dirty_words * sizeof(uint64_t));
+    }
+    delta.have_base = 1;
+    delta.base_epoch = base_epoch;
+    delta.seq = 0;
+}
+
+/**
+ * @brief Finds the next run of dirty counters at or after *i; returns 0 when there is none.
+ */
+static int next_run(int64_t num_counters, int64_t *i, int64_t *start)
+{
+    while (*i < num_counters && !(delta_dirty[*i >> 6] & ((uint64_t)1 << (*i & 63))))
+    {
+        // Skip whole clean words quickly
+        *i = delta_dirty[*i >> 6] ? *i + 1 : (*i | 63) + 1;
+    }
+    if (*i >= num_counters)
+    {
+        return 0;
+    }
+
+    *start = *i;
+    while (*i < num_counters && (delta_dirty[*i >> 6] & ((uint64_t)1 << (*i & 63))))
+    {
+        (*i)++;
+    }
+    return 1;
+}
+
+/**
+ * @brief Serializes the dirty runs of the local slice into a freshly allocated buffer.
+ */
+static char *pack_runs(int rank, const counter_t *counters, int64_t num_counters, int64_t first, uint64_t *runs, uint64_t *bytes, uint64_t *sum)
+{
+    // Sized exactly: one header per run plus one value per dirty counter
+    size_t capacity = 0;
+    int64_t i = 0, start;
+    while (next_run(num_counters, &i, &start))
+    {
+        capacity += sizeof(DeltaRun) + (size_t)(i - start) * sizeof(int32_t);
+    }
+    char *buffer = malloc(capacity > 0 ? capacity : 1);
+    if (!buffer)
+    {
+        fprintf(stderr, "Memory allocation failed on rank %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    *runs = 0;
+    *bytes = 0;
+    *sum = 0;
+    i = 0;
+    while (next_run(num_counters, &i, &start))
+    {
+        DeltaRun run = {(uint64_t)(first + start), (uint32_t)(i - start), 0};
+        memcpy(buffer + *bytes, &run, sizeof(run));
+        // Runs are 16 bytes and values 4, so the values of every run stay aligned
+        counter_widen((int32_t *)(buffer + *bytes + sizeof(run)), counters + start, run.length);
+        *bytes += sizeof(run) + run.length * sizeof(int32_t);
+        *sum += counter_checksum(counters + start, run.start, run.length);
+        (*runs)++;
+    }
+    return buffer;
+}
+
+void checkpoint_delta(int rank, int size, counter_t *counters, int64_t num_counters, const Config *cfg)
+{
+    MPI_Comm comm = buddy_world_comm();
+
+    if (!delta_dirty)
+    {
+        delta_track_reset(num_counters);
+        delta.have_base = 0;
+    }
+
+    // Full base on first use and when the delta chain gets too long (compaction)
+    if (!delta.have_base || delta.seq >= cfg->delta_compact)
+    {
+        int old_seq = delta.seq;
+        checkpoint_binary(rank, size, counters, num_counters, cfg);
+        delta_rebase(checkpoint_epoch());
+
+        // The new base supersedes every previous delta
+        for (int s = 1; rank == 0 && s <= old_seq; s++)
+        {
+            char path[sizeof(cfg->filepath) + 32];
+            delta_path(path, sizeof(path), cfg->filepath, s);
+            remove(path);
+        }
+        return;
+    }
+
+    int64_t first = offset(rank, size, cfg->num_counters);
+    uint64_t local[3], global[3];
+    char *buffer = pack_runs(rank, counters, num_counters, first, &local[0], &local[1], &local[2]);
+    MPI_Allreduce(local, global, 3, MPI_UINT64_T, MPI_SUM, comm);
+
+    // Each rank writes its runs right after those of the lower ranks
+    uint64_t position = 0;
+    MPI_Exscan(&local[1], &position, 1, MPI_UINT64_T, MPI_SUM, comm);
+    if (rank == 0)
+    {
+        position = 0;
+    }
+
+    delta.seq++;
+    char path[sizeof(cfg->filepath) + 32], staged[sizeof(path) + sizeof(DELTA_STAGED_SUFFIX)];
+    delta_path(path, sizeof(path), cfg->filepath, delta.seq);
+    snprintf(staged, sizeof(staged), "%s%s", path, DELTA_STAGED_SUFFIX);
+
+    // Staged, so a crash mid-write cannot leave a torn delta in the chain
+    MPI_File fh;
+    if (MPI_File_open(comm, staged, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+    {
+        fprintf(stderr, "Could not open file %s with MPI-IO on rank %d\n", staged, rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    MPI_File_set_size(fh, CKPT_DELTA_HEADER_SIZE + (MPI_Offset)global[1]);
+
+    uint64_t epoch = checkpoint_next_epoch();
+    if (rank == 0)
+    {
+        DeltaHeader header = {CKPT_DELTA_MAGIC, CKPT_VERSION, delta.base_epoch, epoch, global[0], global[1], global[2]};
+        if (MPI_File_write_at(fh, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE) != MPI_SUCCESS)
+        {
+            fprintf(stderr, "Failed to write delta header to %s\n", staged);
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+    }
+    // A fully dirty slice can exceed INT_MAX bytes
+    MPI_Datatype runs = checkpoint_byte_type(local[1]);
+    if (MPI_File_write_at_all(fh, CKPT_DELTA_HEADER_SIZE + (MPI_Offset)position, buffer, 1, runs, MPI_STATUS_IGNORE) != MPI_SUCCESS)
+    {
+        fprintf(stderr, "Collective write to %s failed on rank %d\n", staged, rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    MPI_Type_free(&runs);
+    MPI_File_sync(fh);
+    MPI_File_close(&fh);
+    free(buffer);
+    commit_delta(comm, rank, staged, path, cfg);
+
+    // Everything dirty is now on disk
+    memset(delta_dirty, 0, dirty_words * sizeof(uint64_t));
+}
+
+/**
+ * @brief Reads and verifies one delta of the given base; returns its payload, NULL if the chain ends here.
+ */
+static char *read_delta(int rank, const char *path, uint64_t base_epoch, DeltaHeader *header)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+    {
+        return NULL;
+    }
+
+    // Stop at the first delta of another base: it is left over from an older chain
+    if (fread(header, sizeof(*header), 1, f) != 1 || header->magic != CKPT_DELTA_MAGIC ||
+        header->version < 1 || header->version > CKPT_VERSION || header->base_epoch != base_epoch)
+    {
+        fclose(f);
+        return NULL;
+    }
+
+    char *payload = malloc(header->payload_bytes > 0 ? header->payload_bytes : 1);
+    if (!payload || fread(payload, 1, header->payload_bytes, f) != header->payload_bytes)
+    {
+        fprintf(stderr, "Warning: Truncated delta %s on rank %d, ignoring it and later deltas\n", path, rank);
+        free(payload);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+
+    // Verify the whole delta before applying any of it
+    uint64_t sum = 0;
+    size_t pos = 0;
+    int valid = 1;
+    for (uint64_t r = 0; valid && r < header->num_runs; r++)
+    {
+        DeltaRun run;
+        if (pos + sizeof(run) > header->payload_bytes)
+        {
+            valid = 0;
+            break;
+        }
+        memcpy(&run, payload + pos, sizeof(run));
+        pos += sizeof(run);
+        if (pos + run.length * sizeof(int32_t) > header->payload_bytes)
+        {
+            valid = 0;
+            break;
+        }
+        for (uint32_t k = 0; k < run.length; k++)
+        {
+            int32_t value;
+            memcpy(&value, payload + pos + k * sizeof(int32_t), sizeof(value));
+            sum += ckpt_checksum(&value, run.start + k, 1);
+        }
+        pos += run.length * sizeof(int32_t);
+    }
+    if (!valid || sum != header->checksum)
+    {
+        fprintf(stderr, "Warning: Corrupted delta %s on rank %d, ignoring it and later deltas\n", path, rank);
+        free(payload);
+        return NULL;
+    }
+    return payload;
+}
+
+uint64_t delta_replay(int rank, const Config *cfg, uint64_t base_epoch, counter_t *counters, int64_t first, int64_t num_counters)
+{
+    MPI_Comm comm = buddy_world_comm();
+    uint64_t last_epoch = base_epoch;
+    int applied = 0;
+
+    for (int seq = 1;; seq++)
+    {
+        // Rank 0 reads and verifies each delta once, then every rank takes its runs
+        DeltaHeader header;
+        char *payload = NULL;
+        int found = 0;
+        if (rank == 0)
+        {
+            char path[sizeof(cfg->filepath) + 32];
+            delta_path(path, sizeof(path), cfg->filepath, seq);
+            payload = read_delta(rank, path, base_epoch, &header);
+            found = payload != NULL;
+        }
+        MPI_Bcast(&found, 1, MPI_INT, 0, comm);
+        if (!found)
+        {
+            break;
+        }
+        MPI_Bcast(&header, sizeof(header), MPI_BYTE, 0, comm);
+        if (rank != 0)
+        {
+            payload = malloc(header.payload_bytes > 0 ? header.payload_bytes : 1);
+            if (!payload)
+            {
+                fprintf(stderr, "Memory allocation failed on rank %d\n", rank);
+                MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+            }
+        }
+        MPI_Datatype bytes = checkpoint_byte_type(header.payload_bytes);
+        MPI_Bcast(payload, 1, bytes, 0, comm);
+        MPI_Type_free(&bytes);
+
+        // Apply the intersection of every run with the local range
+        size_t pos = 0;
+        for (uint64_t r = 0; r < header.num_runs; r++)
+        {
+            DeltaRun run;
+            memcpy(&run, payload + pos, sizeof(run));
+            pos += sizeof(run);
+            uint64_t lo = run.start > (uint64_t)first ? run.start : (uint64_t)first;
+            uint64_t hi = run.start + run.length;
+            hi = hi < (uint64_t)(first + num_counters) ? hi : (uint64_t)(first + num_counters);
+            if (hi > lo)
+            {
+                // The whole delta verified, so its values fit the counters
+                counter_narrow(counters + (lo - first), (const int32_t *)(payload + pos) + (lo - run.start), (int64_t)(hi - lo));
+            }
+            pos += run.length * sizeof(int32_t);
+        }
+        free(payload);
+
+        last_epoch = header.epoch;
+        applied = seq;
+    }
+
+    // Later deltas continue this chain
+    delta.have_base = 1;
+    delta.base_epoch = base_epoch;
+    delta.seq = applied;
+    return last_epoch;
+}
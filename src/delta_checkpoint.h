@@ -0,0 +1,108 @@
+/**
+ * @file delta_checkpoint.h
+ * @brief Incremental checkpoints that only store counters changed since the last one.
+ *
+ * A dirty bitmap over the local counters records which ones were incremented. A
+ * delta checkpoint writes the dirty counters as (index, values) runs into
+ * "<filepath>.delta.<seq>", relative to the last binary base written at
+ * "<filepath>". Each delta is written to "<filepath>.delta.<seq>.tmp", synced and
+ * renamed into place once every rank has written it, so the chain only ever holds
+ * complete deltas. After cfg->delta_compact deltas a new full base is written and
+ * the old deltas are removed (compaction). restart() replays base plus deltas.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef DELTA_CHECKPOINT_H
+#define DELTA_CHECKPOINT_H
+
+#include <stdint.h>
+
+#include "config.h"
+#include "counter.h"
+
+/** @brief Dirty bitmap of the local counters, NULL when tracking is disabled */
+extern uint64_t *delta_dirty;
+
+/**
+ * @brief Marks a local counter as changed since the last checkpoint.
+ *
+ * @param index Local index of the counter
+ *
+ * @note No-op when dirty tracking is disabled
+ */
+static inline void delta_mark_dirty(int64_t index)
+{
+    if (delta_dirty)
+    {
+        delta_dirty[index >> 6] |= (uint64_t)1 << (index & 63);
+    }
+}
+
+/**
+ * @brief Marks every local counter as changed since the last checkpoint.
+ *
+ * @note No-op when dirty tracking is disabled
+ */
+void delta_mark_all(void);
+
+/**
+ * @brief Enables dirty tracking for a local slice, with every counter clean.
+ *
+ * Called whenever the local counters are known to match the checkpoint on disk,
+ * i.e. at startup and after each restart.
+ *
+ * @param num_counters Number of counters in the local array
+ */
+void delta_track_reset(int64_t num_counters);
+
+/**
+ * @brief Declares a new full base written outside of this module.
+ *
+ * Used by the asynchronous checkpoints: the bitmap is cleared and the following
+ * deltas are made relative to the given base epoch.
+ *
+ * @param base_epoch Epoch of the new base checkpoint
+ */
+void delta_rebase(uint64_t base_epoch);
+
+/**
+ * @brief Writes a delta checkpoint, or a full base when compaction is due.
+ *
+ * A full base is written on the first call, after a restart that found no base,
+ * and every cfg->delta_compact deltas. Otherwise only the dirty runs are written,
+ * each rank at its prefix-sum offset in the shared delta file.
+ *
+ * @param rank Current MPI rank
+ * @param size Total number of MPI ranks
+ * @param counters Pointer to the local counters array
+ * @param num_counters Number of counters in the local array
+ * @param cfg Runtime configuration (base checkpoint path, compaction interval)
+ *
+ * @note Collective over buddy_world_comm(): every rank must call it
+ */
+void checkpoint_delta(int rank, int size, counter_t *counters, int64_t num_counters, const Config *cfg);
+
+/**
+ * @brief Applies the deltas of a base checkpoint to this rank's slice.
+ *
+ * Delta files are read in sequence order until one is missing, belongs to another
+ * base, or fails its checksum. Rank 0 reads and verifies each delta and broadcasts
+ * it, so the shared file is read once; every rank applies the runs intersecting
+ * its local range.
+ *
+ * @param rank Current MPI rank (used for error reporting)
+ * @param cfg Runtime configuration (base checkpoint path)
+ * @param base_epoch Epoch found in the header of the base checkpoint
+ * @param counters Local counters array, already loaded from the base
+ * @param first Global index of counters[0]
+ * @param num_counters Number of counters in the local array
+ * @return Epoch of the last applied delta, or base_epoch if none was applied
+ *
+ * @note Collective over buddy_world_comm(): every rank must call it
+ */
+uint64_t delta_replay(int rank, const Config *cfg, uint64_t base_epoch, counter_t *counters, int64_t first, int64_t num_counters);
+
+#endif /* DELTA_CHECKPOINT_H */
@@ -0,0 +1,82 @@
+/**
+ * @file hybrid.c
+ * @brief Implementation of the per-rank thread team.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <mpi.h>
+#include <stdio.h>
+
+#include "hybrid.h"
+
+/** @brief Current team size and the ceiling it may grow to */
+static struct
+{
+    int threads;
+    int ceiling;
+} team = {1, 1};
+
+void hybrid_init(int provided, int rank, const Config *cfg)
+{
+    team.threads = cfg->threads;
+    team.ceiling = cfg->max_threads;
+
+#ifndef _OPENMP
+    if (team.ceiling > 1 && rank == 0)
+    {
+        fprintf(stderr, "Warning: Built without OpenMP, running one thread per rank\n");
+    }
+    team.threads = team.ceiling = 1;
+#endif
+
+    if (team.ceiling > 1 && provided < MPI_THREAD_FUNNELED)
+    {
+        if (rank == 0)
+        {
+            fprintf(stderr, "Warning: MPI does not provide MPI_THREAD_FUNNELED, running one thread per rank\n");
+        }
+        team.threads = team.ceiling = 1;
+    }
+}
+
+int hybrid_threads(void)
+{
+    return team.threads;
+}
+
+void hybrid_set_threads(int threads)
+{
+    team.threads = threads < team.ceiling ? threads : team.ceiling;
+}
+
+ResizeDecision hybrid_absorb(ResizeDecision decision, int rank, int size, const Config *cfg)
+{
+    int64_t next;
+    if (decision.suggestion == SHOULD_EXPAND && team.threads < team.ceiling)
+    {
+        // The capacity of the requested processes, as far as the ceiling allows
+        next = ((int64_t)(size + decision.procs) * team.threads + size - 1) / size;
+        next = next < team.ceiling ? next : team.ceiling;
+    }
+    else if (decision.suggestion == SHOULD_SHRINK && team.threads > cfg->threads)
+    {
+        // Give back the threads gained from expansions before releasing processes
+        next = (int64_t)(size - decision.procs) * team.threads / size;
+        next = next > cfg->threads ? next : cfg->threads;
+    }
+    else
+    {
+        return decision;
+    }
+
+    if (rank == 0 && cfg->verbosity >= 1)
+    {
+        printf("Hybrid: %d -> %lld threads per rank instead of %s by %d processes\n", team.threads, (long long)next,
+               decision.suggestion == SHOULD_EXPAND ? "expanding" : "shrinking", decision.procs);
+    }
+    team.threads = (int)next;
+    return (ResizeDecision){SHOULD_STAY, 0};
+}
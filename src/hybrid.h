@@ -0,0 +1,67 @@
+/**
+ * @file hybrid.h
+ * @brief Threads inside each rank for the counter loop (hybrid MPI+OpenMP).
+ *
+ * With --threads=N every rank splits the increment/compute() loop over its live
+ * counters across an OpenMP team of N threads, and so does run_chunk() when work
+ * stealing is on. Everything else (reductions, RMA, checkpoints, DMR) stays on the
+ * main thread, so MPI is initialized with MPI_THREAD_FUNNELED. Fewer, fatter
+ * ranks per node mean fewer checkpoint files, collective participants and
+ * processes to spawn.
+ *
+ * The team is also the first thing a reconfiguration resizes: while a rank is
+ * below --max-threads, an expand request is turned into more threads per rank for
+ * the same capacity instead of new processes, and a shrink first gives back the
+ * threads gained that way. Only requests the team cannot absorb reach DMR.
+ * Rank 0 sizes the team in hybrid_absorb() and every rank adopts its size with
+ * hybrid_set_threads(); ranks spawned by DMR start with --threads until then.
+ *
+ * Built without OpenMP, or when the MPI library does not provide
+ * MPI_THREAD_FUNNELED, every rank runs a single thread.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef HYBRID_H
+#define HYBRID_H
+
+#include "config.h"
+#include "resize_policy.h"
+
+/**
+ * @brief Sets up the thread team of this rank.
+ *
+ * @param provided Thread support level returned by MPI_Init_thread()
+ * @param rank Rank of the process, used to print warnings once
+ * @param cfg Runtime configuration (threads, max_threads)
+ */
+void hybrid_init(int provided, int rank, const Config *cfg);
+
+/**
+ * @brief Returns the current number of threads of this rank.
+ *
+ * @return Threads to use for the counter loop
+ */
+int hybrid_threads(void);
+
+/**
+ * @brief Sets the number of threads of this rank, as decided by rank 0.
+ *
+ * @param threads Threads per rank, clamped to the ceiling of this rank
+ */
+void hybrid_set_threads(int threads);
+
+/**
+ * @brief Resizes the thread team in place of DMR when it can.
+ *
+ * @param decision Decision of the resize policy
+ * @param rank Rank in the current communicator; rank 0 reports thread resizes
+ * @param size Size of the current communicator
+ * @param cfg Runtime configuration (threads, verbosity)
+ * @return SHOULD_STAY if the team absorbed the request, the original decision otherwise
+ */
+ResizeDecision hybrid_absorb(ResizeDecision decision, int rank, int size, const Config *cfg);
+
+#endif /* HYBRID_H */
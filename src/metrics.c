@@ -0,0 +1,260 @@
+/**
+ * @file metrics.c
+ * @brief Implementation of the live metrics snapshot.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <mpi.h>
+
+#include "metrics.h"
+#include "hybrid.h"
+
+/** @brief Start of the snapshot, up to the digits of its generation */
+#define METRICS_HEAD "dmr-metrics 1\ngeneration "
+/** @brief Width of the generation number, so that it can be rewritten in place */
+#define GENERATION_DIGITS 12
+
+/** @brief Names of the states published while a phase runs, indexed by MetricsPhase */
+static const char *phase_states[METRICS_PHASE_COUNT] = {"checkpoint", "restart"};
+
+/** @brief State of the snapshots of this process */
+static struct
+{
+    int enabled;
+    const Config *cfg;
+    char *map;                              /**< Mapped status file, NULL until rank 0 publishes */
+    unsigned long long generation;          /**< Generation of the last snapshot, even once complete */
+    int failed;                             /**< 1 once the file could not be mapped: no retries */
+    const char *state;
+    double started[METRICS_PHASE_COUNT];
+    double seconds[METRICS_PHASE_COUNT];
+    int checkpointed;                       /**< 1 after a checkpoint(), until its reconfiguration is recorded */
+    double reconfig_seconds;
+    int reconfigurations;
+    int resize_from;
+    int resize_to;
+    double moved_bytes;
+    int iteration;
+    int size;
+    GlobalProgress progress;
+    double rate;                            /**< Iterations per second between the last two snapshots */
+    double last;                            /**< MPI_Wtime() of the last snapshot, negative before the first */
+    int iterations_since;
+} metrics;
+
+/**
+ * @brief Maps the status file; on failure the snapshots are dropped with a warning.
+ */
+static int open_map(void)
+{
+    if (metrics.map)
+    {
+        return 1;
+    }
+    if (metrics.failed)
+    {
+        return 0;
+    }
+
+    int fd = open(metrics.cfg->metrics_path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0 || ftruncate(fd, METRICS_FILE_SIZE) != 0)
+    {
+        fprintf(stderr, "Warning: Could not create metrics file %s, no metrics are published\n",
+                metrics.cfg->metrics_path);
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        metrics.failed = 1;
+        return 0;
+    }
+    void *map = mmap(NULL, METRICS_FILE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        fprintf(stderr, "Warning: Could not map metrics file %s, no metrics are published\n",
+                metrics.cfg->metrics_path);
+        metrics.failed = 1;
+        return 0;
+    }
+    metrics.map = map;
+    return 1;
+}
+
+/**
+ * @brief Rewrites the snapshot in the status file.
+ */
+static void publish(void)
+{
+    if (!open_map())
+    {
+        return;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    // Formatted aside, then copied in under an odd generation: readers retry until they see an even one
+    unsigned long long generation = metrics.generation + 2;
+    char text[METRICS_FILE_SIZE];
+    int length = snprintf(text, sizeof(text),
+                          METRICS_HEAD "%0*llu\n"
+                          "pid %d\n"
+                          "state %s\n"
+                          "updated %lld.%03ld\n"
+                          "interval %g\n"
+                          "iteration %d\n"
+                          "ranks %d\n"
+                          "threads %d\n"
+                          "iterations_per_second %.3f\n"
+                          "live_counters %lld\n"
+                          "remaining %lld\n"
+                          "checkpoint_seconds %.6f\n"
+                          "restart_seconds %.6f\n"
+                          "reconfig_seconds %.6f\n"
+                          "reconfigurations %d\n"
+                          "last_resize %d %d\n"
+                          "moved_bytes %.0f\n"
+                          "end %0*llu\n",
+                          GENERATION_DIGITS, generation, (int)getpid(), metrics.state, (long long)now.tv_sec, now.tv_nsec / 1000000,
+                          metrics.cfg->metrics_interval, metrics.iteration, metrics.size, hybrid_threads(),
+                          metrics.rate, (long long)metrics.progress.live, (long long)metrics.progress.remaining,
+                          metrics.seconds[METRICS_CHECKPOINT], metrics.seconds[METRICS_RESTART],
+                          metrics.reconfig_seconds, metrics.reconfigurations, metrics.resize_from, metrics.resize_to,
+                          metrics.moved_bytes, GENERATION_DIGITS, generation);
+    if (length < 0 || length >= (int)sizeof(text))
+    {
+        length = (int)sizeof(text) - 1;
+    }
+
+    // Empty lines pad the snapshot to the size of the file
+    memset(text + length, '\n', sizeof(text) - (size_t)length);
+
+    // Odd generation, body, then the even generation of the new snapshot, in that order
+    size_t digits = sizeof(METRICS_HEAD) - 1;
+    char odd[GENERATION_DIGITS + 1];
+    snprintf(odd, sizeof(odd), "%0*llu", GENERATION_DIGITS, generation - 1);
+    if (metrics.generation == 0)
+    {
+        memcpy(metrics.map, text, digits);
+    }
+    memcpy(metrics.map + digits, odd, GENERATION_DIGITS);
+    __sync_synchronize();
+    memcpy(metrics.map + digits + GENERATION_DIGITS, text + digits + GENERATION_DIGITS,
+           sizeof(text) - digits - GENERATION_DIGITS);
+    __sync_synchronize();
+    memcpy(metrics.map + digits, text + digits, GENERATION_DIGITS);
+    metrics.generation = generation;
+    msync(metrics.map, METRICS_FILE_SIZE, MS_ASYNC);
+}
+
+void metrics_init(const Config *cfg)
+{
+    metrics.enabled = cfg->metrics_path[0] != '\0';
+    metrics.cfg = cfg;
+    metrics.state = "running";
+    metrics.last = -1.0;
+}
+
+void metrics_begin(MetricsPhase phase)
+{
+    if (!metrics.enabled)
+    {
+        return;
+    }
+    metrics.started[phase] = MPI_Wtime();
+    metrics.state = phase_states[phase];
+
+    // Only the process that published as rank 0 holds the map
+    if (metrics.map)
+    {
+        publish();
+    }
+}
+
+void metrics_end(MetricsPhase phase)
+{
+    if (!metrics.enabled)
+    {
+        return;
+    }
+    metrics.seconds[phase] = MPI_Wtime() - metrics.started[phase];
+    metrics.state = "running";
+    if (phase == METRICS_CHECKPOINT)
+    {
+        metrics.checkpointed = 1;
+    }
+}
+
+void metrics_moved(double bytes)
+{
+    metrics.moved_bytes = bytes;
+}
+
+void metrics_reconfig(int rank, int old_size, int new_size, double seconds)
+{
+    // dmr_check() runs every iteration; only the calls that reconfigured ran checkpoint()
+    if (!metrics.enabled || rank != 0 || !metrics.checkpointed)
+    {
+        return;
+    }
+    metrics.checkpointed = 0;
+    metrics.reconfig_seconds = seconds;
+    metrics.reconfigurations++;
+    if (new_size != old_size)
+    {
+        metrics.resize_from = old_size;
+        metrics.resize_to = new_size;
+    }
+    metrics.size = new_size;
+    publish();
+}
+
+void metrics_update(int rank, int size, int iteration, const GlobalProgress *progress)
+{
+    if (!metrics.enabled || rank != 0)
+    {
+        return;
+    }
+    metrics.iterations_since++;
+    metrics.iteration = iteration;
+    metrics.size = size;
+    metrics.progress = *progress;
+
+    double now = MPI_Wtime();
+    if (metrics.last >= 0.0 && now - metrics.last < metrics.cfg->metrics_interval)
+    {
+        return;
+    }
+
+    // No rate for the first snapshot: there is no previous one to compare with
+    metrics.rate = metrics.last >= 0.0 && now > metrics.last ? metrics.iterations_since / (now - metrics.last) : 0.0;
+    metrics.last = now;
+    metrics.iterations_since = 0;
+    publish();
+}
+
+void metrics_close(void)
+{
+    if (metrics.map)
+    {
+        // The main loop only ends once no counter is live anywhere
+        metrics.state = "finished";
+        metrics.progress.live = 0;
+        metrics.progress.remaining = 0;
+        publish();
+        munmap(metrics.map, METRICS_FILE_SIZE);
+        metrics.map = NULL;
+    }
+    metrics.enabled = 0;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file metrics.h
+ * @brief Live metrics snapshot published by rank 0 for scripts/monitor.sh.
+ *
+ * squeue only tells whether the job runs. With --metrics=F, rank 0 maps the
+ * file F (MAP_SHARED, METRICS_FILE_SIZE bytes) and rewrites a small text
+ * snapshot in it at most every --metrics-interval seconds, and at every phase
+ * change, so a monitor can follow the application without parsing its stdout:
+ *
+ *     dmr-metrics 1
+ *     generation 000000000042    even once the snapshot is complete
+ *     pid 4242
+ *     state running              running, checkpoint, restart or finished
+ *     updated 1760427000.125     Unix time of this snapshot
+ *     interval 1                 --metrics-interval
+ *     iteration 120
+ *     ranks 8
+ *     threads 4
+ *     iterations_per_second 11.8
+ *     live_counters 81234
+ *     remaining 162468           increments left across all counters, -1 unless --policy=cost
+ *     checkpoint_seconds 0.412   last checkpoint() on rank 0
+ *     restart_seconds 0.198      last restart() on rank 0
+ *     reconfig_seconds 0.733     last whole DMR_AUTO call on rank 0
+ *     reconfigurations 3
+ *     last_resize 6 8            ranks before and after the last resize
+ *     moved_bytes 16777216       counter bytes that changed rank in the last resize
+ *     end 000000000042           generation again
+ *
+ * One "key value" pair per line, padded with empty lines to the size of the
+ * file. The file is rewritten in place, so a snapshot is published like a
+ * seqlock: the generation turns odd, the rest of the snapshot, "end" included,
+ * is copied in, and the generation turns even again. A reader accepts a copy
+ * whose generation is even and equal to the one after "end", and reads again
+ * otherwise. Every value
+ * comes from data the main loop already has (the termination reduction, the
+ * redistribution plan), so publishing adds no communication. A stall shows as
+ * an "updated" time older than a few intervals.
+ *
+ * The process that is rank 0 when a snapshot is due owns the file, so the
+ * snapshots continue on the new rank 0 after a recovery (buddy.h).
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "config.h"
+#include "termination.h"
+
+/** @brief Size of the mapped status file */
+#define METRICS_FILE_SIZE 1024
+
+/**
+ * @brief Phases whose duration is published.
+ */
+typedef enum
+{
+    METRICS_CHECKPOINT = 0, /**< Whole checkpoint() callback */
+    METRICS_RESTART,        /**< Whole restart() callback */
+    METRICS_PHASE_COUNT
+} MetricsPhase;
+
+/**
+ * @brief Enables the snapshots if a metrics file is configured.
+ *
+ * @param cfg Runtime configuration (metrics_path, metrics_interval)
+ */
+void metrics_init(const Config *cfg);
+
+/**
+ * @brief Marks the start of a phase; rank 0 publishes the new state right away.
+ *
+ * @param phase Phase starting
+ */
+void metrics_begin(MetricsPhase phase);
+
+/**
+ * @brief Marks the end of a phase started by metrics_begin() and keeps its duration.
+ *
+ * @param phase Phase ending
+ */
+void metrics_end(MetricsPhase phase);
+
+/**
+ * @brief Records the counter bytes that changed rank in a resize.
+ *
+ * @param bytes Bytes of the new slices that came from another rank
+ *
+ * @note Called by rank 0
+ */
+void metrics_moved(double bytes);
+
+/**
+ * @brief Records a reconfiguration and publishes a snapshot.
+ *
+ * Calls of DMR_AUTO that did not run checkpoint() are ignored.
+ *
+ * @param rank Current MPI rank; only rank 0 publishes
+ * @param old_size Communicator size before the reconfiguration
+ * @param new_size Communicator size after the reconfiguration
+ * @param seconds Time of the DMR_AUTO call on this rank
+ */
+void metrics_reconfig(int rank, int old_size, int new_size, double seconds);
+
+/**
+ * @brief Counts one iteration and publishes a snapshot if the interval has elapsed.
+ *
+ * @param rank Current MPI rank; only rank 0 publishes
+ * @param size Total number of MPI ranks
+ * @param iteration Iteration number
+ * @param progress Global progress from termination_finish()
+ *
+ * @note Local operation
+ */
+void metrics_update(int rank, int size, int iteration, const GlobalProgress *progress);
+
+/**
+ * @brief Publishes the final snapshot, in state "finished", and unmaps the file.
+ */
+void metrics_close(void);
+
+#endif /* METRICS_H */
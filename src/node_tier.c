@@ -0,0 +1,414 @@
+/**
+ * @file node_tier.c
+ * @brief Implementation of the node-local checkpoint tier and its drain.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "test.h"
+#include "node_tier.h"
+#include "checkpoint_commit.h"
+#include "partition.h"
+#include "buddy.h"
+
+/** @brief Room for the per-job directory name appended to node_dir */
+#define TIER_DIR_SUFFIX 64
+/** @brief Room for the "<epoch>.<rank>" file name appended to the directory */
+#define TIER_FILE_SUFFIX 48
+
+/** @brief Last node checkpoint of this process and the drain it started */
+static struct
+{
+    uint64_t epoch;
+    int size;
+    int draining;
+    int failed;
+    int pending;
+    pthread_t thread;
+    struct
+    {
+        char dir[sizeof(((Config *)0)->node_dir) + TIER_DIR_SUFFIX];
+        char filepath[CKPT_PATH_SIZE];
+        uint64_t epoch;
+        int writer_size;
+        int64_t total;
+        const Partition *layout;
+        int header;
+        uint64_t checksum;
+        int count;
+        int *members;
+    } job;
+} tier;
+
+/**
+ * @brief Builds the per-job directory: node_dir, job id and a hash of the checkpoint path.
+ */
+static void tier_dir(char *out, size_t out_size, const Config *cfg)
+{
+    // FNV-1a keeps runs with different checkpoint paths apart on a shared node
+    uint32_t hash = 2166136261u;
+    for (const char *c = cfg->filepath; *c; c++)
+    {
+        hash = (hash ^ (unsigned char)*c) * 16777619u;
+    }
+    const char *job = getenv("SLURM_JOB_ID");
+    snprintf(out, out_size, "%sdmr_%.24s_%08x/", cfg->node_dir, job ? job : "local", hash);
+}
+
+/**
+ * @brief Builds the path of the slice written by rank in epoch.
+ */
+static void slice_path(char *out, size_t out_size, const char *dir, uint64_t epoch, int rank)
+{
+    snprintf(out, out_size, "%s%llu.%d", dir, (unsigned long long)epoch, rank);
+}
+
+/**
+ * @brief Loads and verifies a node slice file, returning its values or NULL.
+ */
+static int32_t *read_slice(const char *path, uint64_t epoch, int64_t first, int64_t count)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+    {
+        return NULL;
+    }
+
+    // Slice files are single-writer binary checkpoints of the slice, with its CRCs
+    CheckpointHeader header;
+    int32_t *values = NULL;
+    if (ckpt_read_header(f, &header) == 0 && ckpt_header_validate(&header) == 0 && header.epoch == epoch &&
+        header.num_counters == (uint64_t)count)
+    {
+        values = malloc((count > 0 ? count : 1) * sizeof(int32_t));
+        if (values && (fread(values, sizeof(int32_t), count, f) != (size_t)count ||
+                       ckpt_checksum(values, first, count) != header.checksum ||
+                       ckpt_verify_slice(f, &header, values, 0, count) != 0))
+        {
+            free(values);
+            values = NULL;
+        }
+    }
+    fclose(f);
+    return values;
+}
+
+/**
+ * @brief Removes the files of a node directory older than epoch (every file when epoch is UINT64_MAX).
+ */
+static void remove_older(const char *dir, uint64_t epoch)
+{
+    DIR *d = opendir(dir);
+    if (!d)
+    {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL)
+    {
+        unsigned long long file_epoch;
+        if (sscanf(entry->d_name, "%llu.", &file_epoch) == 1 && file_epoch < epoch)
+        {
+            char path[sizeof(tier.job.dir) + 256];
+            snprintf(path, sizeof(path), "%s%s", dir, entry->d_name);
+            unlink(path);
+        }
+    }
+    closedir(d);
+}
+
+/**
+ * @brief Background drain: copies the node slices into the global file, then drops older epochs.
+ *
+ * Runs without any MPI call; errors are reported through tier.failed.
+ */
+static void *drain(void *arg)
+{
+    (void)arg;
+    int fd = open(tier.job.filepath, O_WRONLY | O_CREAT, 0644);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Could not open file %s for the node drain\n", tier.job.filepath);
+        tier.failed = 1;
+        return NULL;
+    }
+
+    // Every leader sizes the staged file, so no drain depends on another one having started
+    if (ftruncate(fd, ckpt_crc_position(tier.job.total, tier.job.writer_size, tier.job.writer_size)) != 0)
+    {
+        fprintf(stderr, "Could not size file %s for the node drain\n", tier.job.filepath);
+        tier.failed = 1;
+    }
+
+    for (int m = 0; m < tier.job.count && !tier.failed; m++)
+    {
+        int r = tier.job.members[m];
+        int block = partition_block(tier.job.layout, r);
+        int64_t first = tier.job.layout->starts[block];
+        int64_t count = tier.job.layout->starts[block + 1] - first;
+        char path[sizeof(tier.job.dir) + TIER_FILE_SUFFIX];
+        slice_path(path, sizeof(path), tier.job.dir, tier.job.epoch, r);
+
+        int32_t *values = read_slice(path, tier.job.epoch, first, count);
+
+        // The values at the slice's offset, its CRCs at the place of its block in the table
+        uint64_t num_crcs = ckpt_crc_count(count);
+        uint32_t *crcs = malloc((num_crcs > 0 ? num_crcs : 1) * sizeof(uint32_t));
+        size_t bytes = (size_t)count * sizeof(int32_t);
+        if (values && crcs)
+        {
+            ckpt_crc_slice(values, count, crcs);
+        }
+        if (!values || !crcs ||
+            pwrite(fd, values, bytes, CKPT_HEADER_SIZE + (off_t)first * (off_t)sizeof(int32_t)) != (ssize_t)bytes ||
+            pwrite(fd, crcs, num_crcs * sizeof(uint32_t), ckpt_crc_position(tier.job.total, tier.job.writer_size, block)) !=
+                (ssize_t)(num_crcs * sizeof(uint32_t)))
+        {
+            fprintf(stderr, "Failed to drain node slice %s into %s\n", path, tier.job.filepath);
+            tier.failed = 1;
+        }
+        free(values);
+        free(crcs);
+    }
+
+    // The header goes last, once this node's values are in place
+    if (!tier.failed && tier.job.header)
+    {
+        CheckpointHeader header;
+        ckpt_header_init(&header, tier.job.total, tier.job.writer_size, tier.job.epoch, tier.job.checksum);
+        if (pwrite(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header))
+        {
+            fprintf(stderr, "Failed to write checkpoint header to %s\n", tier.job.filepath);
+            tier.failed = 1;
+        }
+    }
+
+    // On stable storage before node_tier_settle() commits it
+    if (!tier.failed && fsync(fd) != 0)
+    {
+        fprintf(stderr, "Failed to sync file %s after the node drain\n", tier.job.filepath);
+        tier.failed = 1;
+    }
+    close(fd);
+
+    if (!tier.failed)
+    {
+        remove_older(tier.job.dir, tier.job.epoch);
+    }
+    return NULL;
+}
+
+void node_tier_drain_wait(void)
+{
+    if (!tier.draining)
+    {
+        return;
+    }
+
+    pthread_join(tier.thread, NULL);
+    tier.draining = 0;
+    free(tier.job.members);
+    tier.job.members = NULL;
+    if (tier.failed)
+    {
+        fprintf(stderr, "Node checkpoint drain failed\n");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+}
+
+void node_tier_settle(MPI_Comm comm, const Config *cfg)
+{
+    node_tier_drain_wait();
+
+    // Rank 0 leads its node, so it knows whether a drained file is waiting for its commit
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    int pending = rank == 0 && tier.pending;
+    MPI_Bcast(&pending, 1, MPI_INT, 0, comm);
+    if (pending)
+    {
+        checkpoint_commit(comm, rank, cfg);
+    }
+    else
+    {
+        MPI_Barrier(comm);
+    }
+    tier.pending = 0;
+}
+
+void node_tier_checkpoint(int rank, int size, const counter_t *counters, int64_t num_counters, const Config *cfg)
+{
+    MPI_Comm comm = buddy_world_comm();
+
+    // One drain at a time: the job description and the staged file are reused
+    node_tier_settle(comm, cfg);
+
+    char dir[sizeof(tier.job.dir)];
+    tier_dir(dir, sizeof(dir), cfg);
+    if (mkdir(dir, 0700) != 0 && errno != EEXIST)
+    {
+        fprintf(stderr, "Could not create node checkpoint directory %s on rank %d\n", dir, rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    uint64_t epoch = checkpoint_next_epoch();
+    int64_t first = offset(rank, size, cfg->num_counters);
+    uint64_t local_sum = counter_checksum(counters, first, num_counters);
+
+    // Written under a temporary name, so a reader never sees a partial slice
+    char path[sizeof(dir) + TIER_FILE_SUFFIX], temp[sizeof(path) + 8];
+    slice_path(path, sizeof(path), dir, epoch, rank);
+    snprintf(temp, sizeof(temp), "%s.tmp", path);
+    FILE *f = fopen(temp, "wb");
+    const int32_t *values = counter_view(counters, num_counters);
+    int ok = f && ckpt_write_binary(f, values, num_counters, epoch, local_sum) == 0;
+    counter_view_release(values, counters);
+    if (f)
+    {
+        ok = fclose(f) == 0 && ok;
+    }
+    if (!ok || rename(temp, path) != 0)
+    {
+        fprintf(stderr, "Failed to write node checkpoint %s on rank %d\n", path, rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    uint64_t global_sum = 0;
+    MPI_Reduce(&local_sum, &global_sum, 1, MPI_UINT64_T, MPI_SUM, 0, comm);
+
+    // The lowest rank of every node collects the ranks whose slices it drains
+    MPI_Comm node;
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node);
+    int node_rank, node_size;
+    MPI_Comm_rank(node, &node_rank);
+    MPI_Comm_size(node, &node_size);
+
+    int *members = NULL;
+    if (node_rank == 0)
+    {
+        members = malloc(node_size * sizeof(int));
+        if (!members)
+        {
+            fprintf(stderr, "Memory allocation failed on rank %d\n", rank);
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+    }
+    // Members write their file before joining the gather, so the leader can drain right away
+    MPI_Gather(&rank, 1, MPI_INT, members, 1, MPI_INT, 0, node);
+    MPI_Comm_free(&node);
+
+    if (node_rank == 0)
+    {
+        snprintf(tier.job.dir, sizeof(tier.job.dir), "%s", dir);
+        checkpoint_staged_path(tier.job.filepath, sizeof(tier.job.filepath), cfg);
+        tier.job.epoch = epoch;
+        tier.job.writer_size = size;
+        tier.job.total = cfg->num_counters;
+        // Captured now: a remap of this size during the drain makes a new table
+        tier.job.layout = partition_get(size, cfg->num_counters);
+        tier.job.header = rank == 0;
+        tier.job.checksum = global_sum;
+        tier.job.count = node_size;
+        tier.job.members = members;
+        tier.failed = 0;
+        if (pthread_create(&tier.thread, NULL, drain, NULL) != 0)
+        {
+            fprintf(stderr, "Could not start the node drain on rank %d\n", rank);
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        tier.draining = 1;
+        tier.pending = 1;
+    }
+
+    tier.epoch = epoch;
+    tier.size = size;
+}
+
+uint64_t node_tier_restore(int rank, int size, counter_t *counters, int64_t num_counters, const Config *cfg)
+{
+    MPI_Comm comm = buddy_world_comm();
+
+    // Rank 0 survived the reconfiguration and knows the layout the slices were written with
+    uint64_t layout[2] = {tier.epoch, (uint64_t)tier.size};
+    MPI_Bcast(layout, 2, MPI_UINT64_T, 0, comm);
+    uint64_t epoch = layout[0];
+    int old_size = (int)layout[1];
+
+    char dir[sizeof(tier.job.dir)];
+    tier_dir(dir, sizeof(dir), cfg);
+
+    // Copy the overlap of the old slices spanning the new one
+    int hit = epoch > 0 && old_size > 0;
+    int64_t first = offset(rank, size, cfg->num_counters);
+    int64_t end = first + num_counters;
+    const Partition *old_layout = hit ? partition_get(old_size, cfg->num_counters) : NULL;
+    int b_lo = 0, b_hi = 0;
+    if (hit)
+    {
+        partition_overlap(old_layout, first, num_counters, &b_lo, &b_hi);
+    }
+    for (int b = b_lo; hit && b < b_hi; b++)
+    {
+        // Slice files are named after the rank that held the block
+        int r = partition_rank(old_layout, b);
+        int64_t old_first = offset(r, old_size, cfg->num_counters);
+        int64_t old_end = old_first + dimension(r, old_size, cfg->num_counters);
+        if (old_end <= first || old_first >= end)
+        {
+            continue;
+        }
+
+        char path[sizeof(dir) + TIER_FILE_SUFFIX];
+        slice_path(path, sizeof(path), dir, epoch, r);
+        int32_t *values = read_slice(path, epoch, old_first, old_end - old_first);
+        if (!values)
+        {
+            hit = 0;
+            break;
+        }
+        int64_t lo = old_first > first ? old_first : first;
+        int64_t hi = old_end < end ? old_end : end;
+        hit = counter_narrow(counters + (lo - first), values + (lo - old_first), hi - lo) == 0;
+        free(values);
+    }
+
+    int all = 0;
+    MPI_Allreduce(&hit, &all, 1, MPI_INT, MPI_MIN, comm);
+    if (!all)
+    {
+        // The global file is only complete once every drain is over and committed
+        node_tier_settle(comm, cfg);
+        return 0;
+    }
+    return epoch;
+}
+
+void node_tier_close(MPI_Comm comm, const Config *cfg)
+{
+    node_tier_settle(comm, cfg);
+
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm node;
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node);
+    int node_rank;
+    MPI_Comm_rank(node, &node_rank);
+    MPI_Barrier(node);
+    MPI_Comm_free(&node);
+
+    if (node_rank == 0)
+    {
+        char dir[sizeof(tier.job.dir)];
+        tier_dir(dir, sizeof(dir), cfg);
+        remove_older(dir, UINT64_MAX);
+        rmdir(dir);
+    }
+}
@@ -0,0 +1,98 @@
+/**
+ * @file node_tier.h
+ * @brief Two-level checkpoint: node-local files drained to the parallel filesystem.
+ *
+ * In CKPT_MODE_NODE, checkpoint() writes every rank's slice as a small binary
+ * checkpoint (checkpoint_format.h header plus values) into a per-job directory of
+ * node_dir, by default the /dev/shm tmpfs. Writing it is a memory copy, so the
+ * reconfiguration is not held up by the shared filesystem. One leader per node
+ * (the lowest rank sharing its memory, found with MPI_Comm_split_type) then
+ * drains the slices of its node into the staged global file (see
+ * checkpoint_commit.h) from a background thread, which makes no MPI call. The
+ * staged file is committed by node_tier_settle(), once every drain is over.
+ *
+ * restart() reads the slices it needs from the node directory when they are
+ * there, which is the case for every rank of a shrink, or of an expansion within
+ * the same nodes, since the files outlive the processes that wrote them. If any
+ * rank misses a slice (e.g. it was spawned on another node), every rank waits for
+ * the drains and reads the global file instead.
+ *
+ * A drain still running when its leader leaves is completed before the process
+ * exits. Files of older epochs are removed by the node leaders after each drain,
+ * and the whole directory by the final ranks at exit; nodes released by DMR keep
+ * the files of their last epoch.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef NODE_TIER_H
+#define NODE_TIER_H
+
+#include <mpi.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "counter.h"
+
+/**
+ * @brief Writes the local slice to the node tier and starts the drain of this node.
+ *
+ * The drain of the previous checkpoint, if any, is completed first.
+ *
+ * @param rank Current MPI rank
+ * @param size Total number of MPI ranks
+ * @param counters Pointer to the local counters array
+ * @param num_counters Number of counters in the local array
+ * @param cfg Runtime configuration (node_dir, filepath, global counter count)
+ *
+ * @note Collective over buddy_world_comm() before the reconfiguration
+ */
+void node_tier_checkpoint(int rank, int size, const counter_t *counters, int64_t num_counters, const Config *cfg);
+
+/**
+ * @brief Loads the local slice of the new layout from the node tier.
+ *
+ * @param rank MPI rank in the new communicator
+ * @param size Size of the new communicator
+ * @param counters Local counters array, already sized for the new layout
+ * @param num_counters Number of counters this rank owns in the new layout
+ * @param cfg Runtime configuration (node_dir, global counter count)
+ * @return Epoch of the restored checkpoint, or 0 if some rank missed a slice; the
+ *         drains are then complete and the global file can be read instead
+ *
+ * @note Collective over buddy_world_comm() after the reconfiguration
+ * @note The return value is the same on every rank
+ */
+uint64_t node_tier_restore(int rank, int size, counter_t *counters, int64_t num_counters, const Config *cfg);
+
+/**
+ * @brief Completes the drains of every rank and commits the global file they wrote.
+ *
+ * @param comm Communicator of the current configuration
+ * @param cfg Runtime configuration (filepath)
+ *
+ * @note Collective over comm; rank 0, which leads its node in every configuration,
+ *       knows whether a drained file is waiting for its commit
+ */
+void node_tier_settle(MPI_Comm comm, const Config *cfg);
+
+/**
+ * @brief Waits for the drain started by this process, if any.
+ *
+ * @note Local operation; aborts if the drain failed
+ */
+void node_tier_drain_wait(void);
+
+/**
+ * @brief Completes the drains and removes the node directories of the final ranks.
+ *
+ * @param comm Communicator of the final configuration
+ * @param cfg Runtime configuration (node_dir)
+ *
+ * @note Collective over comm
+ */
+void node_tier_close(MPI_Comm comm, const Config *cfg);
+
+#endif /* NODE_TIER_H */
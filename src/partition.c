@@ -0,0 +1,175 @@
+/**
+ * @file partition.c
+ * @brief Implementation of the partition tables.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <mpi.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "partition.h"
+
+/** @brief Tables built so far, most recent first */
+static struct
+{
+    pthread_mutex_t lock;
+    Partition *head;
+} tables = {PTHREAD_MUTEX_INITIALIZER, NULL};
+
+/**
+ * @brief Returns the most recent table of a layout, or NULL; the lock is held.
+ */
+static Partition *find(int size, int64_t total)
+{
+    Partition *p = tables.head;
+    while (p && (p->size != size || p->total != total))
+    {
+        p = p->next;
+    }
+    return p;
+}
+
+const Partition *partition_get(int size, int64_t total)
+{
+    if (size <= 0 || total <= 0)
+    {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&tables.lock);
+    Partition *p = find(size, total);
+
+    if (!p)
+    {
+        p = malloc(sizeof(Partition));
+        int64_t *starts = malloc(((size_t)size + 1) * sizeof(int64_t));
+        if (!p || !starts)
+        {
+            fprintf(stderr, "Memory allocation failed for the partition of %lld counters over %d ranks\n", (long long)total, size);
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+
+        // Integer split: the remainder goes to the lowest ranks, one counter each
+        int64_t base = total / size;
+        int64_t extra = total % size;
+        for (int r = 0; r <= size; r++)
+        {
+            starts[r] = r * base + (r < extra ? r : extra);
+        }
+
+        p->size = size;
+        p->total = total;
+        p->starts = starts;
+        p->block_of = NULL;
+        p->rank_of = NULL;
+        p->next = tables.head;
+        tables.head = p;
+    }
+    pthread_mutex_unlock(&tables.lock);
+    return p;
+}
+
+const Partition *partition_remap(int size, int64_t total, const int *block_of)
+{
+    const Partition *current = partition_get(size, total);
+    if (!current)
+    {
+        return NULL;
+    }
+
+    // Identity mappings are stored as NULL, so that they compare equal
+    int identity = 1;
+    for (int r = 0; block_of && r < size; r++)
+    {
+        identity = identity && block_of[r] == r;
+    }
+    if (identity)
+    {
+        block_of = NULL;
+    }
+
+    pthread_mutex_lock(&tables.lock);
+    Partition *p = find(size, total);
+    int same = block_of ? p->block_of && memcmp(p->block_of, block_of, (size_t)size * sizeof(int)) == 0 : !p->block_of;
+    if (!same)
+    {
+        // A new table in front of the old one, which stays valid for whoever holds it
+        Partition *q = malloc(sizeof(Partition));
+        int64_t *starts = malloc(((size_t)size + 1) * sizeof(int64_t));
+        int *maps = block_of ? malloc(2 * (size_t)size * sizeof(int)) : NULL;
+        if (!q || !starts || (block_of && !maps))
+        {
+            fprintf(stderr, "Memory allocation failed for the mapping of %d ranks\n", size);
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        memcpy(starts, p->starts, ((size_t)size + 1) * sizeof(int64_t));
+        q->size = size;
+        q->total = total;
+        q->starts = starts;
+        q->block_of = maps;
+        q->rank_of = maps ? maps + size : NULL;
+        for (int r = 0; maps && r < size; r++)
+        {
+            q->block_of[r] = block_of[r];
+            q->rank_of[block_of[r]] = r;
+        }
+        q->next = tables.head;
+        tables.head = q;
+        p = q;
+    }
+    pthread_mutex_unlock(&tables.lock);
+    return p;
+}
+
+/**
+ * @brief Returns the block holding a counter.
+ */
+static int block_at(const Partition *p, int64_t index)
+{
+    // Last block starting at or before index: it is not empty
+    int lo = 0, hi = p->size - 1;
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo + 1) / 2;
+        if (p->starts[mid] <= index)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid - 1;
+        }
+    }
+    return lo;
+}
+
+int partition_owner(const Partition *p, int64_t index)
+{
+    return partition_rank(p, block_at(p, index));
+}
+
+void partition_overlap(const Partition *p, int64_t first, int64_t count, int *lo, int *hi)
+{
+    *lo = block_at(p, first);
+    *hi = block_at(p, first + count - 1) + 1;
+}
+
+void partition_release(void)
+{
+    pthread_mutex_lock(&tables.lock);
+    while (tables.head)
+    {
+        Partition *p = tables.head;
+        tables.head = p->next;
+        free(p->starts);
+        free(p->block_of);
+        free(p);
+    }
+    pthread_mutex_unlock(&tables.lock);
+}
@@ -0,0 +1,115 @@
+/**
+ * @file partition.h
+ * @brief Partition tables of the global counter array over the ranks.
+ *
+ * A Partition holds the first counter of every block, plus the total,
+ * as a prefix-sum table of size + 1 entries computed with exact 64-bit integer
+ * arithmetic: the first total % size blocks get one counter more than the
+ * others. offset() and dimension() read it, and partition_owner() finds the
+ * rank holding a counter with a binary search in O(log size).
+ *
+ * The table splits the counters into size blocks in global order; block b
+ * goes to rank b unless the table carries a mapping. partition_remap()
+ * installs one for a layout (see topology.h): later lookups of the layout
+ * return a new table with the mapping, and tables handed out before stay
+ * valid and unchanged.
+ *
+ * partition_get() builds the table of a layout the first time it is asked for
+ * and keeps it for the rest of the process: a job only ever runs on a few
+ * communicator sizes, and restart(), checkpoint(), the in-memory
+ * redistribution and the node tier then share the same tables. Tables are
+ * never modified or moved once built, so the pointers stay valid and can be
+ * read from any thread, including the node tier drain.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include <stdint.h>
+
+/**
+ * @brief Split of total counters over size ranks.
+ */
+typedef struct Partition
+{
+    int size;               /**< Number of ranks */
+    int64_t total;          /**< Number of counters */
+    int64_t *starts;        /**< First counter of every block, starts[size] == total */
+    int *block_of;          /**< Block held by every rank, NULL when rank r holds block r */
+    int *rank_of;           /**< Rank holding every block, the inverse of block_of */
+    struct Partition *next; /**< Next table kept by partition_get() */
+} Partition;
+
+/**
+ * @brief Returns the block, i.e. the position in global order, of a rank's slice.
+ */
+static inline int partition_block(const Partition *p, int rank)
+{
+    return p->block_of ? p->block_of[rank] : rank;
+}
+
+/**
+ * @brief Returns the rank holding a block.
+ */
+static inline int partition_rank(const Partition *p, int block)
+{
+    return p->rank_of ? p->rank_of[block] : block;
+}
+
+/**
+ * @brief Returns the table of a layout, building it on first use.
+ *
+ * @param size Number of ranks
+ * @param total Number of counters
+ * @return Shared table, NULL if size or total is not positive
+ *
+ * @note Thread safe
+ */
+const Partition *partition_get(int size, int64_t total);
+
+/**
+ * @brief Installs the assignment of blocks to ranks of a layout.
+ *
+ * @param size Number of ranks
+ * @param total Number of counters
+ * @param block_of Block of every rank, a permutation of [0, size); NULL for the identity
+ * @return Table of the layout with that mapping, NULL if size or total is not positive
+ *
+ * @note Thread safe; a no-op if the layout already has this mapping
+ */
+const Partition *partition_remap(int size, int64_t total, const int *block_of);
+
+/**
+ * @brief Returns the rank whose slice holds a counter.
+ *
+ * @param p Partition table
+ * @param index Global counter index, in [0, p->total)
+ * @return Owner rank; ranks with empty slices never own a counter
+ */
+int partition_owner(const Partition *p, int64_t index);
+
+/**
+ * @brief Returns the blocks that overlap a range of counters.
+ *
+ * @param p Partition table
+ * @param first First global counter of the range
+ * @param count Number of counters in the range, positive
+ * @param lo Output, first overlapping block
+ * @param hi Output, one past the last overlapping block
+ *
+ * @note partition_rank() gives the rank holding each of them
+ */
+void partition_overlap(const Partition *p, int64_t first, int64_t count, int *lo, int *hi);
+
+/**
+ * @brief Frees every table built by partition_get().
+ *
+ * @note No table may be used afterwards
+ */
+void partition_release(void);
+
+#endif /* PARTITION_H */
@@ -0,0 +1,83 @@
+/**
+ * @file prewarm.c
+ * @brief Implementation of the expand preparation.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "prewarm.h"
+#include "arena.h"
+#include "counter.h"
+#include "hybrid.h"
+#include "partition.h"
+#include "test.h"
+
+/** @brief Layout the buffers were last prepared for */
+static struct
+{
+    int size;
+    int target;
+} prepared;
+
+/**
+ * @brief Writes a buffer with the threads of the counter loop, so its pages are faulted in on their NUMA nodes.
+ */
+static void fault_in(char *buffer, size_t bytes)
+{
+    int threads = hybrid_threads();
+#pragma omp parallel for num_threads(threads) schedule(static)
+    for (int t = 0; t < threads; t++)
+    {
+        size_t lo = bytes * t / threads, hi = bytes * (t + 1) / threads;
+        memset(buffer + lo, 0, hi - lo);
+    }
+}
+
+void prewarm_expand(int rank, int size, int procs, int64_t num_counters, const Config *cfg)
+{
+    int target = size + procs;
+    if (procs <= 0 || (prepared.size == size && prepared.target == target))
+    {
+        return;
+    }
+    prepared.size = size;
+    prepared.target = target;
+
+    partition_get(target, cfg->num_counters);
+
+    // Survivors of an expand keep their rank: restart() takes a buffer for this slice
+    size_t bytes[2] = {(size_t)dimension(rank, target, cfg->num_counters) * sizeof(counter_t), 0};
+    // checkpoint() stashes the current slice in another one
+    if (cfg->ckpt_mode == CKPT_MODE_MEMORY)
+    {
+        bytes[1] = (size_t)num_counters * sizeof(counter_t);
+    }
+
+    // Both held at once, so they land in distinct slots; released, they stay mapped. Either may later
+    // serve either request, so both are faulted in up to the larger one
+    size_t largest = bytes[0] > bytes[1] ? bytes[0] : bytes[1];
+    void *buffers[2] = {NULL, NULL};
+    for (int b = 0; b < 2; b++)
+    {
+        if (bytes[b] > 0)
+        {
+            buffers[b] = arena_acquire(largest);
+            fault_in(buffers[b], largest);
+        }
+    }
+    for (int b = 0; b < 2; b++)
+    {
+        arena_release(buffers[b]);
+    }
+
+    if (rank == 0 && cfg->verbosity >= 1)
+    {
+        printf("Prewarm: expand to %d ranks forecast, %.1f MB of buffers ready on rank 0\n", target,
+               (double)largest * (bytes[1] > 0 ? 2 : 1) / (1 << 20));
+    }
+}
@@ -0,0 +1,42 @@
+/**
+ * @file prewarm.h
+ * @brief Preparation of a forecast expand while the counters keep computing.
+ *
+ * An expand blocks the running ranks from their checkpoint until the spawned
+ * processes have restarted. With --prewarm=N, main() asks the resize policy
+ * every iteration whether an expand is expected within N iterations (see
+ * resize_policy_forecast()). When one is, prewarm_expand() does ahead of time
+ * the work of the switchover that does not depend on the counter values: it
+ * builds the partition table of the target size and faults in the arena
+ * buffers that checkpoint() and restart() will take, the in-memory stash and
+ * the slice of the target layout. The switchover then only moves data.
+ *
+ * Spawning the processes is up to DMR, which offers no standby pool; what the
+ * spawned processes do before restart() is kept short instead (see main()).
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef PREWARM_H
+#define PREWARM_H
+
+#include <stdint.h>
+
+#include "config.h"
+
+/**
+ * @brief Prepares the buffers of an expand by procs processes, once per forecast.
+ *
+ * @param rank Current MPI rank
+ * @param size Current communicator size
+ * @param procs Processes the expand is expected to add
+ * @param num_counters Number of counters in the local array
+ * @param cfg Runtime configuration (num_counters, ckpt_mode, verbosity)
+ *
+ * @note Collective only in the sense that every rank gets the same forecast; no communication
+ */
+void prewarm_expand(int rank, int size, int procs, int64_t num_counters, const Config *cfg);
+
+#endif /* PREWARM_H */
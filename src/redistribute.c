@@ -0,0 +1,183 @@
+/**
+ * @file redistribute.c
+ * @brief Implementation of in-memory counter redistribution.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include "test.h"
+#include "redistribute.h"
+#include "partition.h"
+#include "arena.h"
+#include "topology.h"
+#include "buddy.h"
+
+/** @brief Size expected after the next reconfiguration (rank 0's value is used) */
+static int target_size = 0;
+
+/** @brief Counters kept across the reconfiguration, laid out for stash_size ranks */
+static counter_t *stash = NULL;
+static int64_t stash_count = 0;
+static int stash_size = 0;
+static int stash_rank = -1;
+
+/**
+ * @brief Moves counters from a layout over src_size ranks to one over dst_size ranks.
+ *
+ * This rank holds src_count counters starting at offset(rank, src_size) and
+ * receives dimension(rank, dst_size) counters starting at offset(rank, dst_size).
+ * Both layouts use the offset()/dimension() partition of total counters.
+ *
+ * @note Global positions are 64-bit; per-peer counts and displacements are local
+ *       to one slice and therefore fit the int arguments of MPI_Alltoallv
+ */
+static void exchange(MPI_Comm comm, int rank, int64_t total, int src_size, const counter_t *src, int64_t src_count, int dst_size, counter_t *dst)
+{
+    int size;
+    MPI_Comm_size(comm, &size);
+
+    int *sendcounts = calloc(4 * size, sizeof(int));
+    if (!sendcounts)
+    {
+        fprintf(stderr, "Memory allocation failed on rank %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    int *sdispls = sendcounts + size;
+    int *recvcounts = sdispls + size;
+    int *rdispls = recvcounts + size;
+
+    // Send the overlap of the local source range with the destination ranges it spans
+    const Partition *src_layout = partition_get(src_size, total);
+    const Partition *dst_layout = partition_get(dst_size, total);
+    int64_t src_first = offset(rank, src_size, total);
+    int d_lo = 0, d_hi = 0;
+    if (src_count > 0)
+    {
+        partition_overlap(dst_layout, src_first, src_count, &d_lo, &d_hi);
+    }
+    for (int b = d_lo; b < d_hi; b++)
+    {
+        int d = partition_rank(dst_layout, b);
+        if (d >= size)
+        {
+            continue;
+        }
+        int64_t lo = dst_layout->starts[b];
+        int64_t hi = dst_layout->starts[b + 1];
+        lo = lo > src_first ? lo : src_first;
+        hi = hi < src_first + src_count ? hi : src_first + src_count;
+        if (hi > lo)
+        {
+            sendcounts[d] = (int)(hi - lo);
+            sdispls[d] = (int)(lo - src_first);
+        }
+    }
+
+    // Receivers learn the sizes from the senders, so missing slices show up as zeros
+    MPI_Alltoall(sendcounts, 1, MPI_INT, recvcounts, 1, MPI_INT, comm);
+
+    int64_t dst_first = offset(rank, dst_size, total);
+    for (int s = 0; s < size; s++)
+    {
+        if (recvcounts[s] > 0)
+        {
+            int64_t lo = src_layout->starts[partition_block(src_layout, s)];
+            rdispls[s] = (int)((lo > dst_first ? lo : dst_first) - dst_first);
+        }
+    }
+
+    MPI_Alltoallv(src, sendcounts, sdispls, MPI_COUNTER, dst, recvcounts, rdispls, MPI_COUNTER, comm);
+
+    free(sendcounts);
+}
+
+/**
+ * @brief Drops the current stash, if any.
+ */
+static void release_stash(void)
+{
+    arena_release(stash);
+    stash = NULL;
+    stash_count = 0;
+    stash_size = 0;
+    stash_rank = -1;
+}
+
+void redistribute_set_target(int next_size)
+{
+    target_size = next_size;
+}
+
+void redistribute_stash(int rank, int size, counter_t *counters, int64_t num_counters, const Config *cfg)
+{
+    MPI_Comm comm = buddy_world_comm();
+
+    // Every rank must agree on the layout the stash is expressed in
+    int target = target_size;
+    MPI_Bcast(&target, 1, MPI_INT, 0, comm);
+    if (target <= 0 || target > size)
+    {
+        target = size;
+    }
+    else if (target < size)
+    {
+        // The survivors' slices follow the mapping restart() will install for them
+        topology_prepare_shrink(target, cfg);
+    }
+
+    release_stash();
+    stash_size = target;
+    stash_rank = rank;
+    stash_count = dimension(rank, target, cfg->num_counters);
+    // Same buffer every epoch, from the arena like the counters
+    stash = arena_acquire((size_t)(stash_count > 0 ? stash_count : 1) * sizeof(counter_t));
+
+    if (target == size)
+    {
+        // Layout is kept (or only grows): survivors keep their own slice
+        memcpy(stash, counters, num_counters * sizeof(counter_t));
+    }
+    else
+    {
+        // Shrink: hand the slices of leaving ranks to the survivors now
+        exchange(comm, rank, cfg->num_counters, size, counters, num_counters, target, stash);
+    }
+}
+
+int redistribute_restore(int rank, int size, counter_t *counters, int64_t num_counters, const Config *cfg)
+{
+    MPI_Comm comm = buddy_world_comm();
+
+    // Newly spawned ranks hold no stash and report an empty layout
+    int local[2] = {stash ? stash_size : 0, stash && stash_rank != rank};
+    int global[2];
+    MPI_Allreduce(local, global, 2, MPI_INT, MPI_MAX, comm);
+
+    int64_t held = stash ? stash_count : 0;
+    int64_t total = 0;
+    MPI_Allreduce(&held, &total, 1, MPI_INT64_T, MPI_SUM, comm);
+
+    // The stash is only usable if it is complete and its owners kept their ranks
+    if (global[0] == 0 || global[1] || total != cfg->num_counters)
+    {
+        release_stash();
+        return 0;
+    }
+
+    if (num_counters != dimension(rank, size, cfg->num_counters))
+    {
+        fprintf(stderr, "Counters array does not match the new layout on rank %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    exchange(comm, rank, cfg->num_counters, global[0], stash, held, size, counters);
+    release_stash();
+    return 1;
+}
+
+void redistribute_discard(void)
+{
+    release_stash();
+}
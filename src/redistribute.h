@@ -0,0 +1,87 @@
+/**
+ * @file redistribute.h
+ * @brief In-memory redistribution of counters across DMR reconfigurations.
+ *
+ * Instead of a round trip through the shared filesystem, counter slices are moved
+ * between processes with MPI_Alltoallv. Each process only sends the part of its
+ * slice that overlaps the new offset()/dimension() range of every destination.
+ *
+ * The work is split in two halves because of how DMR reconfigures:
+ * - redistribute_stash() runs as the checkpoint action, on the old communicator,
+ *   while every old rank is still alive. For a shrink it already pushes the data
+ *   of the leaving ranks to the survivors.
+ * - redistribute_restore() runs inside restart(), on the new communicator, and
+ *   moves the stashed slices to their final owners (including newly spawned ranks).
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef REDISTRIBUTE_H
+#define REDISTRIBUTE_H
+
+#include <mpi.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "counter.h"
+
+/**
+ * @brief Records the communicator size expected after the next reconfiguration.
+ *
+ * Only the value set on rank 0 is used; it is broadcast by redistribute_stash().
+ *
+ * @param next_size Expected number of ranks after the reconfiguration
+ *
+ * @note A value <= 0 means "unchanged"
+ */
+void redistribute_set_target(int next_size);
+
+/**
+ * @brief Keeps the local counters in memory for the upcoming reconfiguration.
+ *
+ * If the expected size is smaller than the current one, the counters are
+ * redistributed right away to the layout of the surviving ranks, so that the
+ * leaving ranks can exit without losing their slice. Otherwise the local slice
+ * is copied as is.
+ *
+ * @param rank Current MPI rank
+ * @param size Total number of MPI ranks
+ * @param counters Pointer to the local counters array
+ * @param num_counters Number of counters in the local array
+ * @param cfg Runtime configuration (global counter count)
+ *
+ * @note Collective over buddy_world_comm() before the reconfiguration
+ */
+void redistribute_stash(int rank, int size, counter_t *counters, int64_t num_counters, const Config *cfg);
+
+/**
+ * @brief Moves stashed counters to their owners in the new layout.
+ *
+ * Processes that did not take part in the previous stash (e.g. freshly spawned
+ * ranks) own nothing and only receive. The stash is released in every case.
+ *
+ * @param rank MPI rank in the new communicator
+ * @param size Size of the new communicator
+ * @param counters Local counters array, already sized for the new layout
+ * @param num_counters Number of counters this rank owns in the new layout
+ * @param cfg Runtime configuration (global counter count)
+ * @return 1 if every counter was restored from memory, 0 if the stash was missing
+ *         or incomplete and the caller must load the file checkpoint instead
+ *
+ * @note Collective over buddy_world_comm() after the reconfiguration
+ * @note The return value is the same on every rank
+ */
+int redistribute_restore(int rank, int size, counter_t *counters, int64_t num_counters, const Config *cfg);
+
+/**
+ * @brief Drops the stash without using it.
+ *
+ * Called by restart() when the layout is unchanged and the live counters are kept.
+ *
+ * @note Local operation
+ */
+void redistribute_discard(void);
+
+#endif /* REDISTRIBUTE_H */
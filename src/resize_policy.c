@@ -0,0 +1,295 @@
+/**
+ * @file resize_policy.c
+ * @brief Implementation of the resize policies.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <limits.h>
+#include <stdio.h>
+
+#include "resize_policy.h"
+
+/** @brief Communicator sizes whose increment cost is remembered */
+#define POLICY_HISTORY 64
+/** @brief Iterations at a new size, or after a declined request, before the cost policy decides again */
+#define POLICY_COOLDOWN 2
+/** @brief Fraction of the projected time a resize must win (or may lose, for a shrink) */
+#define POLICY_MARGIN 0.10
+/** @brief Weight of a new measurement in the smoothed costs */
+#define POLICY_SMOOTHING 0.5
+
+/** @brief Signature of a policy; why receives a short explanation of a resize */
+typedef ResizeDecision (*PolicyFunction)(const PolicyMetrics *metrics, const Config *cfg, char *why, size_t why_size);
+
+/** @brief Measurements of the cost policy */
+static struct
+{
+    struct
+    {
+        int size;
+        double cost;
+    } history[POLICY_HISTORY];
+    int sizes;
+    double reconfig_cost;
+    int last_size;
+    int last_threads;
+    int64_t last_live;
+    int hold;
+} model = {.reconfig_cost = -1.0};
+
+/**
+ * @brief Legacy triggers on the local counters, plus idle-rank volunteering.
+ */
+static ResizeDecision decide_threshold(const PolicyMetrics *m, const Config *cfg, char *why, size_t why_size)
+{
+    ResizeDecision decision = {SHOULD_STAY, 0};
+
+    // Expand when counters reach certain thresholds (more processes needed)
+    if (m->first_counter == 3)
+    {
+        decision.suggestion = SHOULD_EXPAND;
+        snprintf(why, why_size, "counters[0] reached 3");
+    }
+    // Shrink when computation is nearly complete (fewer processes needed)
+    else if (m->first_counter == 8)
+    {
+        decision.suggestion = SHOULD_SHRINK;
+        snprintf(why, why_size, "counters[0] reached 8");
+    }
+    // Ranks with nothing left to do volunteer to be released
+    else if (m->progress.idle_ranks >= cfg->resize_step && m->size > cfg->resize_step)
+    {
+        decision.suggestion = SHOULD_SHRINK;
+        snprintf(why, why_size, "%lld ranks idle", (long long)m->progress.idle_ranks);
+    }
+
+    decision.procs = decision.suggestion == SHOULD_STAY ? 0 : cfg->resize_step;
+    return decision;
+}
+
+/**
+ * @brief Smooths a new increment cost measurement into the history of its size.
+ */
+static void record_cost(int size, double cost)
+{
+    for (int i = 0; i < model.sizes; i++)
+    {
+        if (model.history[i].size == size)
+        {
+            model.history[i].cost += POLICY_SMOOTHING * (cost - model.history[i].cost);
+            return;
+        }
+    }
+    if (model.sizes < POLICY_HISTORY)
+    {
+        model.history[model.sizes].size = size;
+        model.history[model.sizes].cost = cost;
+        model.sizes++;
+    }
+}
+
+/**
+ * @brief Returns the increment cost of the measured size closest to size, or -1 if none.
+ */
+static double cost_at(int size)
+{
+    double cost = -1.0;
+    int distance = 0;
+    for (int i = 0; i < model.sizes; i++)
+    {
+        int d = model.history[i].size > size ? model.history[i].size - size : size - model.history[i].size;
+        if (cost < 0.0 || d < distance)
+        {
+            cost = model.history[i].cost;
+            distance = d;
+        }
+    }
+    return cost;
+}
+
+/**
+ * @brief Returns the counters of the most loaded thread when live counters are split over size ranks.
+ */
+static int64_t per_thread(int64_t live, int size, int threads)
+{
+    int64_t per_rank = (live + size - 1) / size;
+    return (per_rank + threads - 1) / threads;
+}
+
+/**
+ * @brief Projected seconds to finish work increments, at most depth per counter, on size ranks.
+ */
+static double projected_time(int size, int threads, int64_t work, int64_t depth)
+{
+    // depth iterations remain, each advancing work / depth live counters on average
+    int64_t live = (work + depth - 1) / depth;
+    return cost_at(size) * (double)depth * (double)per_thread(live, size, threads);
+}
+
+/**
+ * @brief Returns the size of the expand with the largest saving over current seconds, m->size if none pays off.
+ */
+static int cost_expand(const PolicyMetrics *m, const Config *cfg, int64_t work, int64_t depth, double current, double reconfig,
+                       double *best_time)
+{
+    int best = m->size;
+    *best_time = current;
+    for (int k = 1; k <= 2; k++)
+    {
+        int64_t q = m->size + (int64_t)k * cfg->resize_step;
+        if (q > m->progress.live || q > INT_MAX)
+        {
+            break;
+        }
+        double t = projected_time((int)q, m->threads, work, depth) + reconfig;
+        if (t < *best_time && current - t > POLICY_MARGIN * current)
+        {
+            best = (int)q;
+            *best_time = t;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Weighs the reconfiguration overhead against the projected time saved.
+ */
+static ResizeDecision decide_cost(const PolicyMetrics *m, const Config *cfg, char *why, size_t why_size)
+{
+    ResizeDecision decision = {SHOULD_STAY, 0};
+    const GlobalProgress *p = &m->progress;
+
+    // busy_max was measured on the previous iteration: only usable if the layout did not change since
+    if (m->size == model.last_size && m->threads == model.last_threads && model.last_live > 0 && p->busy_max > 0.0)
+    {
+        record_cost(m->size, p->busy_max / per_thread(model.last_live, m->size, m->threads));
+    }
+    model.last_size = m->size;
+    model.last_threads = m->threads;
+    model.last_live = p->live;
+
+    // The progress predates this iteration, which advanced every live counter once
+    int64_t work = p->remaining - p->live;
+    int64_t depth = p->depth - 1;
+    if (model.hold > 0)
+    {
+        model.hold--;
+        return decision;
+    }
+    if (m->iteration < POLICY_COOLDOWN || work <= 0 || cost_at(m->size) < 0.0)
+    {
+        return decision;
+    }
+
+    double reconfig = model.reconfig_cost >= 0.0 ? model.reconfig_cost : cfg->reconfig_cost;
+    double current = projected_time(m->size, m->threads, work, depth);
+    double best_time;
+
+    // Expand: the largest saving, if it beats the overhead by the margin
+    int best = cost_expand(m, cfg, work, depth, current, reconfig, &best_time);
+
+    // Shrink: the smallest size that stays within the margin of the current projection
+    if (best == m->size)
+    {
+        for (int k = 2; k >= 1; k--)
+        {
+            int q = m->size - k * cfg->resize_step;
+            if (q < 1)
+            {
+                continue;
+            }
+            double t = projected_time(q, m->threads, work, depth) + reconfig;
+            if (t <= current * (1.0 + POLICY_MARGIN))
+            {
+                best = q;
+                best_time = t;
+                break;
+            }
+        }
+    }
+
+    if (best != m->size)
+    {
+        decision.suggestion = best > m->size ? SHOULD_EXPAND : SHOULD_SHRINK;
+        decision.procs = best > m->size ? best - m->size : m->size - best;
+        model.hold = POLICY_COOLDOWN;
+        snprintf(why, why_size, "projected %.2f s on %d ranks, %.2f s on %d including %.2f s to reconfigure",
+                 current, m->size, best_time, best, reconfig);
+    }
+    return decision;
+}
+
+/**
+ * @brief Never resizes.
+ */
+static ResizeDecision decide_none(const PolicyMetrics *m, const Config *cfg, char *why, size_t why_size)
+{
+    (void)m;
+    (void)cfg;
+    (void)why;
+    (void)why_size;
+    return (ResizeDecision){SHOULD_STAY, 0};
+}
+
+/** @brief Policies, indexed by ResizePolicy */
+static const PolicyFunction policies[] = {
+    [RESIZE_POLICY_THRESHOLD] = decide_threshold,
+    [RESIZE_POLICY_COST] = decide_cost,
+    [RESIZE_POLICY_NONE] = decide_none,
+};
+
+ResizeDecision resize_policy_decide(const PolicyMetrics *metrics, const Config *cfg)
+{
+    char why[160] = "";
+    ResizeDecision decision = policies[cfg->policy](metrics, cfg, why, sizeof(why));
+
+    if (metrics->rank == 0 && cfg->verbosity >= 1 && decision.suggestion != SHOULD_STAY)
+    {
+        printf("Resize policy %s: %s by %d from %d ranks (%s)\n", resize_policy_name(cfg->policy),
+               decision.suggestion == SHOULD_EXPAND ? "expand" : "shrink", decision.procs, metrics->size, why);
+    }
+    return decision;
+}
+
+int resize_policy_forecast(const PolicyMetrics *metrics, const Config *cfg, int horizon)
+{
+    const PolicyMetrics *m = metrics;
+    if (cfg->policy == RESIZE_POLICY_THRESHOLD)
+    {
+        // counters[0] advances by one per iteration until it finishes
+        int reachable = 3 <= cfg->max_counter_value && m->first_counter < 3 && 3 - m->first_counter <= horizon;
+        return reachable ? cfg->resize_step : 0;
+    }
+    if (cfg->policy != RESIZE_POLICY_COST)
+    {
+        return 0;
+    }
+
+    // An expand that already pays off is only held back by the cooldown
+    int64_t work = m->progress.remaining - m->progress.live;
+    int64_t depth = m->progress.depth - 1;
+    int wait = POLICY_COOLDOWN - m->iteration > model.hold ? POLICY_COOLDOWN - m->iteration : model.hold;
+    if (wait > horizon || work <= 0 || depth <= 0 || cost_at(m->size) < 0.0)
+    {
+        return 0;
+    }
+    double reconfig = model.reconfig_cost >= 0.0 ? model.reconfig_cost : cfg->reconfig_cost;
+    double best_time;
+    int best = cost_expand(m, cfg, work, depth, projected_time(m->size, m->threads, work, depth), reconfig, &best_time);
+    return best - m->size;
+}
+
+void resize_policy_observe_reconfig(double seconds)
+{
+    if (model.reconfig_cost < 0.0)
+    {
+        model.reconfig_cost = seconds;
+    }
+    else
+    {
+        model.reconfig_cost += POLICY_SMOOTHING * (seconds - model.reconfig_cost);
+    }
+}
@@ -0,0 +1,110 @@
+/**
+ * @file resize_policy.h
+ * @brief Pluggable policies deciding DMR expand/shrink requests.
+ *
+ * Once per iteration main() hands the globally reduced progress of the run
+ * (termination.h) to resize_policy_decide(), which returns the suggestion passed
+ * to dmr_check() and the number of processes to add or remove. The policy is
+ * chosen at runtime with --policy, so the same binary can be compared under
+ * different strategies:
+ *
+ * | Policy    | Behaviour                                                       |
+ * |-----------|-----------------------------------------------------------------|
+ * | threshold | expand when counters[0] reaches 3, shrink at 8 or when at least |
+ * |           | resize_step ranks are idle, always by resize_step (default)     |
+ * | cost      | cost model of the projected time to completion                  |
+ * | none      | never resize                                                    |
+ *
+ * The cost policy keeps, per communicator size, the measured time of one counter
+ * increment on the slowest thread, busy_max / ceil(ceil(live / size) / threads),
+ * smoothed over the iterations and epochs run at that size. Load imbalance and
+ * contention show up as a higher cost, i.e. a lower parallel efficiency, at that
+ * size. With depth iterations left, each advancing live = remaining / depth
+ * counters on average, the time left on q ranks is projected as
+ * cost(q) * depth * ceil(ceil(live / q) / threads), using the nearest measured
+ * size for sizes never run. A resize of resize_step or
+ * twice that is requested when:
+ * - expand: it saves more than the reconfiguration cost plus a 10% margin;
+ * - shrink: the smaller size still finishes within 10% of the current
+ *   projection once the reconfiguration cost is paid, releasing processes.
+ *
+ * The reconfiguration cost starts at --reconfig-cost and is replaced by the
+ * smoothed duration of the reconfigurations actually performed. No decision is
+ * taken in the first iterations after a resize, until the new size is measured,
+ * nor right after a request DMR may have declined.
+ *
+ * Only rank 0 runs the policy and keeps the model; main() broadcasts its
+ * decision, so every rank passes the same suggestion to dmr_check().
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef RESIZE_POLICY_H
+#define RESIZE_POLICY_H
+
+#include "dmr.h"
+#include "config.h"
+#include "termination.h"
+
+/**
+ * @brief Inputs of a resize decision.
+ */
+typedef struct
+{
+    int rank;                /**< Rank in the current communicator */
+    int size;                /**< Size of the current communicator */
+    int threads;             /**< Threads per rank running the counter loop (hybrid.h) */
+    int iteration;           /**< Iterations run since the last resize */
+    int first_counter;       /**< Value of the first counter of rank 0 (threshold policy) */
+    GlobalProgress progress; /**< Global progress before the iteration computed */
+} PolicyMetrics;
+
+/**
+ * @brief Outcome of a resize decision.
+ */
+typedef struct
+{
+    DMRSuggestion suggestion; /**< Suggestion for dmr_check() */
+    int procs;                /**< Processes to add or remove, 0 with SHOULD_STAY */
+} ResizeDecision;
+
+/**
+ * @brief Runs the configured policy on the metrics of one iteration.
+ *
+ * Must be called by rank 0 every iteration, even when no resize is wanted, so
+ * that the cost policy keeps measuring. Rank 0 prints the decisions that request a resize
+ * when verbosity is at least 1.
+ *
+ * @param metrics Metrics of the iteration that just computed
+ * @param cfg Runtime configuration (policy, resize_step, reconfig_cost, verbosity)
+ * @return Decision to pass on to DMR
+ */
+ResizeDecision resize_policy_decide(const PolicyMetrics *metrics, const Config *cfg);
+
+/**
+ * @brief Forecasts an expand the policy is likely to request within a few iterations.
+ *
+ * The threshold policy expands when counters[0] reaches 3, which is a known
+ * number of iterations away. The cost policy forecasts an expand that its model
+ * already finds profitable but that the cooldown still holds back. Other
+ * policies never forecast anything. The model is left untouched.
+ *
+ * @param metrics Metrics passed to resize_policy_decide() in this iteration
+ * @param cfg Runtime configuration (policy, resize_step, max_counter_value, reconfig_cost)
+ * @param horizon Iterations to look ahead
+ * @return Processes the forecast expand would add, 0 if none is expected
+ */
+int resize_policy_forecast(const PolicyMetrics *metrics, const Config *cfg, int horizon);
+
+/**
+ * @brief Records the measured duration of a completed reconfiguration.
+ *
+ * Called by rank 0 only, which keeps the model.
+ *
+ * @param seconds Time from dmr_check() to the end of restart()
+ */
+void resize_policy_observe_reconfig(double seconds);
+
+#endif /* RESIZE_POLICY_H */
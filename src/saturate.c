@@ -0,0 +1,243 @@
+/**
+ * @file saturate.c
+ * @brief Implementation of the saturating increment kernels.
+ *
+ * Every vector kernel does a full vector of counters per step and leaves the
+ * last partial vector to the portable loop. Comparisons follow the width and
+ * signedness of counter_t: unsigned for 8 and 16 bit counters, signed for 32.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <pthread.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define SATURATE_X86 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SATURATE_NEON 1
+#endif
+
+#include "saturate.h"
+
+/** @brief Implementation picked at first use and its name */
+static int64_t (*increment)(counter_t *counters, int64_t count, int max_value);
+static const char *increment_name = "scalar";
+static pthread_once_t increment_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Portable saturating increment, one counter at a time.
+ */
+static int64_t increment_scalar(counter_t *counters, int64_t count, int max_value)
+{
+    int64_t live = 0;
+    for (int64_t i = 0; i < count; i++)
+    {
+        counter_t c = counters[i];
+        c += c < max_value;
+        counters[i] = c;
+        live += c < max_value;
+    }
+    return live;
+}
+
+#ifdef SATURATE_X86
+
+// Lane operations of the counter width: a lane is live when min(c, max - 1) == c
+#if COUNTER_BITS == 8
+#define SSE_SET1(v) _mm_set1_epi8((char)(v))
+#define SSE_MIN _mm_min_epu8
+#define SSE_EQ _mm_cmpeq_epi8
+#define SSE_SUB _mm_sub_epi8
+#define AVX_SET1(v) _mm256_set1_epi8((char)(v))
+#define AVX_MIN _mm256_min_epu8
+#define AVX_EQ _mm256_cmpeq_epi8
+#define AVX_SUB _mm256_sub_epi8
+#define ZMM_SET1(v) _mm512_set1_epi8((char)(v))
+#define ZMM_LT _mm512_cmplt_epu8_mask
+#define ZMM_ADD _mm512_mask_add_epi8
+#elif COUNTER_BITS == 16
+#define SSE_SET1(v) _mm_set1_epi16((short)(v))
+#define SSE_MIN _mm_min_epu16
+#define SSE_EQ _mm_cmpeq_epi16
+#define SSE_SUB _mm_sub_epi16
+#define AVX_SET1(v) _mm256_set1_epi16((short)(v))
+#define AVX_MIN _mm256_min_epu16
+#define AVX_EQ _mm256_cmpeq_epi16
+#define AVX_SUB _mm256_sub_epi16
+#define ZMM_SET1(v) _mm512_set1_epi16((short)(v))
+#define ZMM_LT _mm512_cmplt_epu16_mask
+#define ZMM_ADD _mm512_mask_add_epi16
+#else
+#define SSE_SET1 _mm_set1_epi32
+#define SSE_MIN _mm_min_epi32
+#define SSE_EQ _mm_cmpeq_epi32
+#define SSE_SUB _mm_sub_epi32
+#define AVX_SET1 _mm256_set1_epi32
+#define AVX_MIN _mm256_min_epi32
+#define AVX_EQ _mm256_cmpeq_epi32
+#define AVX_SUB _mm256_sub_epi32
+#define ZMM_SET1 _mm512_set1_epi32
+#define ZMM_LT _mm512_cmplt_epi32_mask
+#define ZMM_ADD _mm512_mask_add_epi32
+#endif
+
+/**
+ * @brief SSE4.1 kernel: the live mask (all ones, i.e. -1) is subtracted from the counters.
+ */
+__attribute__((target("sse4.1"))) static int64_t increment_sse41(counter_t *counters, int64_t count, int max_value)
+{
+    const int64_t lanes = sizeof(__m128i) / sizeof(counter_t);
+    const __m128i limit = SSE_SET1(max_value - 1);
+    int64_t live_bytes = 0, i = 0;
+    for (; i + lanes <= count; i += lanes)
+    {
+        __m128i *p = (__m128i *)(counters + i);
+        __m128i c = _mm_loadu_si128(p);
+        c = SSE_SUB(c, SSE_EQ(SSE_MIN(c, limit), c));
+        _mm_storeu_si128(p, c);
+        live_bytes += __builtin_popcount((unsigned int)_mm_movemask_epi8(SSE_EQ(SSE_MIN(c, limit), c)));
+    }
+    return live_bytes / (int64_t)sizeof(counter_t) + increment_scalar(counters + i, count - i, max_value);
+}
+
+/**
+ * @brief AVX2 kernel, the SSE4.1 one on 256-bit vectors.
+ */
+__attribute__((target("avx2"))) static int64_t increment_avx2(counter_t *counters, int64_t count, int max_value)
+{
+    const int64_t lanes = sizeof(__m256i) / sizeof(counter_t);
+    const __m256i limit = AVX_SET1(max_value - 1);
+    int64_t live_bytes = 0, i = 0;
+    for (; i + lanes <= count; i += lanes)
+    {
+        __m256i *p = (__m256i *)(counters + i);
+        __m256i c = _mm256_loadu_si256(p);
+        c = AVX_SUB(c, AVX_EQ(AVX_MIN(c, limit), c));
+        _mm256_storeu_si256(p, c);
+        live_bytes += __builtin_popcount((unsigned int)_mm256_movemask_epi8(AVX_EQ(AVX_MIN(c, limit), c)));
+    }
+    return live_bytes / (int64_t)sizeof(counter_t) + increment_scalar(counters + i, count - i, max_value);
+}
+
+/**
+ * @brief AVX-512BW kernel: compares give lane masks, so the increment is a masked add.
+ */
+__attribute__((target("avx512f,avx512bw"))) static int64_t increment_avx512(counter_t *counters, int64_t count, int max_value)
+{
+    const int64_t lanes = sizeof(__m512i) / sizeof(counter_t);
+    const __m512i limit = ZMM_SET1(max_value);
+    const __m512i one = ZMM_SET1(1);
+    int64_t live = 0, i = 0;
+    for (; i + lanes <= count; i += lanes)
+    {
+        counter_t *p = counters + i;
+        __m512i c = _mm512_loadu_si512(p);
+        c = ZMM_ADD(c, ZMM_LT(c, limit), c, one);
+        _mm512_storeu_si512(p, c);
+        live += __builtin_popcountll((unsigned long long)ZMM_LT(c, limit));
+    }
+    return live + increment_scalar(counters + i, count - i, max_value);
+}
+
+#endif /* SATURATE_X86 */
+
+#ifdef SATURATE_NEON
+
+// Compares give all-ones lanes; shifting the sign bit down turns them into 1 to sum
+#if COUNTER_BITS == 8
+#define NEON_VEC uint8x16_t
+#define NEON_DUP(v) vdupq_n_u8((uint8_t)(v))
+#define NEON_LOAD vld1q_u8
+#define NEON_STORE vst1q_u8
+#define NEON_LT vcltq_u8
+#define NEON_STEP(c, mask) vsubq_u8(c, mask)
+#define NEON_LIVE(mask) vaddvq_u8(vshrq_n_u8(mask, 7))
+#elif COUNTER_BITS == 16
+#define NEON_VEC uint16x8_t
+#define NEON_DUP(v) vdupq_n_u16((uint16_t)(v))
+#define NEON_LOAD vld1q_u16
+#define NEON_STORE vst1q_u16
+#define NEON_LT vcltq_u16
+#define NEON_STEP(c, mask) vsubq_u16(c, mask)
+#define NEON_LIVE(mask) vaddvq_u16(vshrq_n_u16(mask, 15))
+#else
+#define NEON_VEC int32x4_t
+#define NEON_DUP vdupq_n_s32
+#define NEON_LOAD vld1q_s32
+#define NEON_STORE vst1q_s32
+#define NEON_LT vcltq_s32
+#define NEON_STEP(c, mask) vsubq_s32(c, vreinterpretq_s32_u32(mask))
+#define NEON_LIVE(mask) vaddvq_u32(vshrq_n_u32(mask, 31))
+#endif
+
+/**
+ * @brief NEON kernel: the live mask (all ones, i.e. -1) is subtracted from the counters.
+ */
+static int64_t increment_neon(counter_t *counters, int64_t count, int max_value)
+{
+    const int64_t lanes = sizeof(NEON_VEC) / sizeof(counter_t);
+    const NEON_VEC limit = NEON_DUP(max_value);
+    int64_t live = 0, i = 0;
+    for (; i + lanes <= count; i += lanes)
+    {
+        NEON_VEC c = NEON_LOAD(counters + i);
+        c = NEON_STEP(c, NEON_LT(c, limit));
+        NEON_STORE(counters + i, c);
+        live += NEON_LIVE(NEON_LT(c, limit));
+    }
+    return live + increment_scalar(counters + i, count - i, max_value);
+}
+
+#endif /* SATURATE_NEON */
+
+/**
+ * @brief Picks the widest implementation the CPU supports.
+ */
+static void increment_init(void)
+{
+    increment = increment_scalar;
+
+#ifdef SATURATE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+    {
+        increment = increment_avx512;
+        increment_name = "avx512";
+    }
+    else if (__builtin_cpu_supports("avx2"))
+    {
+        increment = increment_avx2;
+        increment_name = "avx2";
+    }
+    else if (__builtin_cpu_supports("sse4.1"))
+    {
+        increment = increment_sse41;
+        increment_name = "sse4.1";
+    }
+#elif defined(SATURATE_NEON)
+    // NEON is part of the AArch64 base architecture
+    increment = increment_neon;
+    increment_name = "neon";
+#endif
+}
+
+int64_t saturate_increment(counter_t *counters, int64_t count, int max_value)
+{
+    // Nothing is live, and max_value - 1 would not fit an unsigned counter
+    if (max_value <= 0 || count <= 0)
+    {
+        return 0;
+    }
+    pthread_once(&increment_once, increment_init);
+    return increment(counters, count, max_value);
+}
+
+const char *saturate_isa(void)
+{
+    pthread_once(&increment_once, increment_init);
+    return increment_name;
+}
@@ -0,0 +1,46 @@
+/**
+ * @file saturate.h
+ * @brief Vectorized saturating increment of a run of counters.
+ *
+ * While every counter of a slice is live, the main loop increments the whole
+ * slice with saturate_increment() instead of walking the active set: each
+ * counter becomes min(c + 1, max_value) without a branch, and the number of
+ * counters still below max_value comes back as a by-product, so the following
+ * check_counters() needs no second pass over the slice.
+ *
+ * The implementation is picked once, on first use, from what the CPU supports:
+ * AVX-512BW, AVX2 or SSE4.1 on x86-64, NEON on AArch64, and a portable loop
+ * otherwise. Each one works on the counter_t width of the build (see counter.h).
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef SATURATE_H
+#define SATURATE_H
+
+#include <stdint.h>
+
+#include "counter.h"
+
+/**
+ * @brief Increments every counter below max_value by one.
+ *
+ * @param counters Counters to increment
+ * @param count Number of counters
+ * @param max_value Value at which a counter stops being incremented
+ * @return Number of counters still below max_value after the increment
+ *
+ * @note Thread safe; callers split a slice between threads in disjoint runs
+ */
+int64_t saturate_increment(counter_t *counters, int64_t count, int max_value);
+
+/**
+ * @brief Returns the name of the implementation saturate_increment() uses.
+ *
+ * @return "avx512", "avx2", "sse4.1", "neon" or "scalar"
+ */
+const char *saturate_isa(void);
+
+#endif /* SATURATE_H */
@@ -0,0 +1,221 @@
+/**
+ * @file status.c
+ * @brief Implementation of the rank-aggregated progress reporting.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "status.h"
+#include "compute_kernel.h"
+#include "work_steal.h"
+
+/** @brief Size of the in-memory per-rank log buffer */
+#define STATUS_LOG_CAPACITY 65536
+
+/** @brief Fields of the summary reduced to rank 0 */
+enum
+{
+    FIELD_MIN = 0,
+    FIELD_MAX,
+    FIELD_SUM,
+    FIELD_FINISHED,
+    FIELD_COUNT,
+    FIELD_RATE,
+    FIELD_STOLEN,
+    FIELD_TOTAL
+};
+
+/** @brief Datatype and operation of the summary reduction, created on first use */
+static MPI_Datatype summary_type = MPI_DATATYPE_NULL;
+static MPI_Op summary_op = MPI_OP_NULL;
+
+/** @brief Time of the previous summary, or of the first iteration, and iterations run since then */
+static double last_time = -1.0;
+static int iterations_since = 0;
+
+/** @brief Per-rank log buffer and the file it is flushed to */
+static char log_buffer[STATUS_LOG_CAPACITY];
+static size_t log_length = 0;
+static FILE *log_file = NULL;
+static char log_path[sizeof(((Config *)0)->checkpoint_dir) + 32];
+
+/**
+ * @brief Combines partial summaries: min/max on the extremes, sums elsewhere.
+ */
+static void combine(void *in, void *inout, int *len, MPI_Datatype *type)
+{
+    (void)type;
+    const double *a = in;
+    double *b = inout;
+    for (int i = 0; i < *len; i++, a += FIELD_TOTAL, b += FIELD_TOTAL)
+    {
+        b[FIELD_MIN] = a[FIELD_MIN] < b[FIELD_MIN] ? a[FIELD_MIN] : b[FIELD_MIN];
+        b[FIELD_MAX] = a[FIELD_MAX] > b[FIELD_MAX] ? a[FIELD_MAX] : b[FIELD_MAX];
+        b[FIELD_SUM] += a[FIELD_SUM];
+        b[FIELD_FINISHED] += a[FIELD_FINISHED];
+        b[FIELD_COUNT] += a[FIELD_COUNT];
+        b[FIELD_RATE] += a[FIELD_RATE];
+        b[FIELD_STOLEN] += a[FIELD_STOLEN];
+    }
+}
+
+/**
+ * @brief Writes the log buffer to the per-rank log file.
+ */
+static void log_flush(void)
+{
+    if (log_length == 0)
+    {
+        return;
+    }
+    if (!log_file)
+    {
+        log_file = fopen(log_path, "w");
+        if (!log_file)
+        {
+            fprintf(stderr, "Warning: Could not open log file %s, dropping per-rank status\n", log_path);
+            log_length = 0;
+            return;
+        }
+    }
+    fwrite(log_buffer, 1, log_length, log_file);
+    log_length = 0;
+}
+
+/**
+ * @brief Appends this rank's counters to the log buffer.
+ */
+static void log_counters(int rank, int iteration, const counter_t *counters, int64_t num_counters, const Config *cfg)
+{
+    if (log_path[0] == '\0')
+    {
+        snprintf(log_path, sizeof(log_path), "%srank_log.%d", cfg->checkpoint_dir, (int)getpid());
+    }
+
+    // Every value takes at most 12 characters ("%d "), plus the line prefix
+    size_t needed = 64 + (size_t)num_counters * 12;
+    if (needed > STATUS_LOG_CAPACITY - log_length)
+    {
+        log_flush();
+    }
+
+    // Lines larger than the buffer go straight to the file
+    char *out = log_buffer + log_length;
+    char *line = needed > STATUS_LOG_CAPACITY ? malloc(needed) : out;
+    if (!line)
+    {
+        fprintf(stderr, "Memory allocation failed on rank %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    size_t length = snprintf(line, needed, "Iteration %d rank %d counters: ", iteration, rank);
+    for (int64_t i = 0; i < num_counters; i++)
+    {
+        length += snprintf(line + length, needed - length, "%d ", counters[i]);
+    }
+    line[length++] = '\n';
+
+    if (line == out)
+    {
+        log_length += length;
+    }
+    else
+    {
+        log_flush();
+        if (log_file)
+        {
+            fwrite(line, 1, length, log_file);
+        }
+        free(line);
+    }
+}
+
+void status_report(MPI_Comm comm, int iteration, const counter_t *counters, int64_t num_counters, const Config *cfg)
+{
+    // The rate of the first report is measured from the first iteration
+    if (last_time < 0.0)
+    {
+        last_time = MPI_Wtime();
+    }
+    else
+    {
+        iterations_since++;
+    }
+    if (cfg->verbosity <= 0 || iteration % cfg->status_interval != 0)
+    {
+        return;
+    }
+
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    if (cfg->verbosity >= 2)
+    {
+        log_counters(rank, iteration, counters, num_counters, cfg);
+    }
+
+    if (summary_op == MPI_OP_NULL)
+    {
+        MPI_Type_contiguous(FIELD_TOTAL, MPI_DOUBLE, &summary_type);
+        MPI_Type_commit(&summary_type);
+        MPI_Op_create(combine, 1, &summary_op);
+    }
+
+    double local[FIELD_TOTAL] = {0};
+    local[FIELD_MIN] = num_counters > 0 ? counters[0] : cfg->max_counter_value;
+    local[FIELD_MAX] = num_counters > 0 ? counters[0] : 0;
+    for (int64_t i = 0; i < num_counters; i++)
+    {
+        local[FIELD_MIN] = counters[i] < local[FIELD_MIN] ? counters[i] : local[FIELD_MIN];
+        local[FIELD_MAX] = counters[i] > local[FIELD_MAX] ? counters[i] : local[FIELD_MAX];
+        local[FIELD_SUM] += counters[i];
+        local[FIELD_FINISHED] += counters[i] >= cfg->max_counter_value;
+    }
+    local[FIELD_COUNT] = (double)num_counters;
+    local[FIELD_RATE] = compute_kernel_rate();
+    local[FIELD_STOLEN] = (double)work_steal_taken();
+
+    // One reduction carries the whole summary
+    double global[FIELD_TOTAL];
+    MPI_Reduce(local, global, 1, summary_type, summary_op, 0, comm);
+
+    if (rank == 0)
+    {
+        double now = MPI_Wtime();
+        double rate = now > last_time ? iterations_since / (now - last_time) : 0.0;
+        last_time = now;
+        iterations_since = 0;
+
+        printf("Iteration %d on %d ranks: counters min %.0f max %.0f mean %.2f, finished %.0f/%.0f, %.2f it/s",
+               iteration, size, global[FIELD_MIN], global[FIELD_MAX], global[FIELD_SUM] / global[FIELD_COUNT],
+               global[FIELD_FINISHED], global[FIELD_COUNT], rate);
+        const char *unit = compute_kernel_unit(cfg->kernel);
+        if (unit)
+        {
+            printf(", %s kernel %.2f %s", compute_kernel_name(cfg->kernel), global[FIELD_RATE], unit);
+        }
+        if (cfg->steal_chunk > 0)
+        {
+            printf(", %.0f chunks stolen", global[FIELD_STOLEN]);
+        }
+        printf("\n");
+    }
+}
+
+void status_close(void)
+{
+    log_flush();
+    if (log_file)
+    {
+        fclose(log_file);
+        log_file = NULL;
+    }
+}
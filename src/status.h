@@ -0,0 +1,57 @@
+/**
+ * @file status.h
+ * @brief Rank-aggregated progress reporting for the main loop.
+ *
+ * Instead of every rank printing its counters every iteration, status_report()
+ * reduces a compact summary to rank 0 with a single MPI_Reduce: minimum, maximum
+ * and mean counter value, number of finished counters, iteration rate and the
+ * compute kernel rate summed over the ranks (see compute_kernel_rate()), plus the
+ * chunks moved by work stealing when it is enabled. Rank 0
+ * prints one line every status_interval iterations (10 by default: each report
+ * scans the local counters, which would otherwise cost a pass per iteration). With verbosity 2, each
+ * process additionally appends its counters
+ * to an in-memory log buffer that is written to "<checkpoint_dir>rank_log.<pid>"
+ * when it fills up and at exit.
+ *
+ * | Verbosity | Output                                      |
+ * |-----------|---------------------------------------------|
+ * | 0         | nothing                                     |
+ * | 1         | rank 0 summary line (default)               |
+ * | 2         | summary plus per-rank counters in the logs  |
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef STATUS_H
+#define STATUS_H
+
+#include <mpi.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "counter.h"
+
+/**
+ * @brief Reports the progress of one iteration.
+ *
+ * @param comm Communicator of the current configuration
+ * @param iteration Iteration number, equal on every rank
+ * @param counters Pointer to the local counters array
+ * @param num_counters Number of counters in the local array
+ * @param cfg Runtime configuration (verbosity, status_interval, max_counter_value,
+ *            checkpoint_dir, kernel)
+ *
+ * @note Collective over comm whenever a summary is due
+ */
+void status_report(MPI_Comm comm, int iteration, const counter_t *counters, int64_t num_counters, const Config *cfg);
+
+/**
+ * @brief Writes the buffered per-rank log and closes it.
+ *
+ * @note Called once per process, before it exits
+ */
+void status_close(void);
+
+#endif /* STATUS_H */
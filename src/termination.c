@@ -0,0 +1,74 @@
+/**
+ * @file termination.c
+ * @brief Implementation of the global completion detection.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include "termination.h"
+
+/** @brief Summed fields of the reduction */
+enum
+{
+    SUM_LIVE = 0,
+    SUM_IDLE,
+    SUM_REMAINING,
+    SUM_TOTAL
+};
+
+/** @brief Maximized fields of the reduction */
+enum
+{
+    MAX_BUSY = 0,
+    MAX_DEPTH,
+    MAX_TOTAL
+};
+
+/** @brief Reductions in flight: local contributions, results and requests */
+static struct
+{
+    int64_t local_sum[SUM_TOTAL];
+    int64_t global_sum[SUM_TOTAL];
+    double local_max[MAX_TOTAL];
+    double global_max[MAX_TOTAL];
+    int measured; /**< 1 if remaining and depth were computed for the reduction in flight */
+    MPI_Request requests[2];
+} reduction = {.requests = {MPI_REQUEST_NULL, MPI_REQUEST_NULL}};
+
+void termination_start(MPI_Comm comm, const counter_t *counters, const ActiveSet *active, const Config *cfg, double busy)
+{
+    // Only the cost policy reads the remaining work: spare the others a pass over the live set
+    int64_t remaining = 0;
+    int depth = 0;
+    reduction.measured = cfg->policy == RESIZE_POLICY_COST;
+    for (int64_t k = 0; reduction.measured && k < active->count; k++)
+    {
+        int left = cfg->max_counter_value - counters[active->live[k]];
+        remaining += left;
+        depth = left > depth ? left : depth;
+    }
+
+    reduction.local_sum[SUM_LIVE] = active->count;
+    reduction.local_sum[SUM_IDLE] = active->count == 0;
+    reduction.local_sum[SUM_REMAINING] = remaining;
+    reduction.local_max[MAX_BUSY] = busy;
+    reduction.local_max[MAX_DEPTH] = depth;
+    MPI_Iallreduce(reduction.local_sum, reduction.global_sum, SUM_TOTAL, MPI_INT64_T, MPI_SUM, comm, &reduction.requests[0]);
+    MPI_Iallreduce(reduction.local_max, reduction.global_max, MAX_TOTAL, MPI_DOUBLE, MPI_MAX, comm, &reduction.requests[1]);
+}
+
+int64_t termination_finish(GlobalProgress *progress)
+{
+    MPI_Waitall(2, reduction.requests, MPI_STATUSES_IGNORE);
+    if (progress)
+    {
+        progress->live = reduction.global_sum[SUM_LIVE];
+        progress->idle_ranks = reduction.global_sum[SUM_IDLE];
+        progress->remaining = reduction.measured ? reduction.global_sum[SUM_REMAINING] : -1;
+        progress->depth = reduction.measured ? (int64_t)reduction.global_max[MAX_DEPTH] : -1;
+        progress->busy_max = reduction.global_max[MAX_BUSY];
+    }
+    return reduction.global_sum[SUM_LIVE];
+}
@@ -0,0 +1,67 @@
+/**
+ * @file termination.h
+ * @brief Global completion detection for the main loop.
+ *
+ * A rank whose slice is finished must not leave the loop on its own: its peers
+ * would be left alone in the dmr_check() collectives. Instead, at the top of every
+ * iteration each rank posts a nonblocking MPI_Iallreduce of its live counter count
+ * and of whether it is idle, computes, and only then collects the result. The
+ * reduction is hidden behind the compute phase and every rank takes the same
+ * decision: the loop ends once no counter was live anywhere.
+ *
+ * The number of idle ranks lets rank 0 volunteer them for a shrink, so processes
+ * with no work left are released instead of spinning. The same round also carries
+ * the remaining work (under the cost policy only, the one policy that reads it)
+ * and the compute time of the slowest rank in the previous iteration, which
+ * feed the resize policy (resize_policy.h).
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef TERMINATION_H
+#define TERMINATION_H
+
+#include <mpi.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "active_set.h"
+#include "counter.h"
+
+/**
+ * @brief Global progress of the computation, as seen before an iteration computes.
+ */
+typedef struct
+{
+    int64_t live;       /**< Live counters across all ranks */
+    int64_t idle_ranks; /**< Ranks without any live counter */
+    int64_t remaining;  /**< Increments left across all counters, -1 unless --policy=cost */
+    int64_t depth;      /**< Increments left on the least advanced counter, -1 unless --policy=cost */
+    double busy_max;    /**< Compute time of the slowest rank in the previous iteration */
+} GlobalProgress;
+
+/**
+ * @brief Starts the reduction of the progress of this iteration.
+ *
+ * @param comm Communicator of the current configuration
+ * @param counters Pointer to the local counters array
+ * @param active Active set of the local counters, before the iteration computes
+ * @param cfg Runtime configuration (max_counter_value, policy)
+ * @param busy Seconds this rank spent computing in the previous iteration
+ *
+ * @note Collective (nonblocking) over comm; must be matched by termination_finish()
+ *       before comm can change in a reconfiguration
+ */
+void termination_start(MPI_Comm comm, const counter_t *counters, const ActiveSet *active, const Config *cfg, double busy);
+
+/**
+ * @brief Completes the reduction started by termination_start().
+ *
+ * @param progress Output global progress, may be NULL
+ * @return Number of live counters across all ranks; 0 means the computation is over
+ */
+int64_t termination_finish(GlobalProgress *progress);
+
+#endif /* TERMINATION_H */
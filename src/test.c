@@ -5,7 +5,7 @@
  * This file contains the main function for a distributed counter simulation using MPI
  * (Message Passing Interface) with Dynamic Memory Recovery (DMR) capabilities.
  * The program simulates a distributed computation where each MPI rank manages
- * a subset of counters, incrementing them until they reach MAX_COUNTER_VALUE.
+ * a subset of counters, incrementing them until they reach the configured maximum value.
  * The system supports dynamic reconfiguration through the DMR library.
  *
  * @author Marco De Rosso
@@ -14,6 +14,26 @@
  */
 
 #include "test.h"
+#include "redistribute.h"
+#include "async_checkpoint.h"
+#include "delta_checkpoint.h"
+#include "compute_kernel.h"
+#include "trace.h"
+#include "bench.h"
+#include "status.h"
+#include "termination.h"
+#include "work_steal.h"
+#include "resize_policy.h"
+#include "hybrid.h"
+#include "node_tier.h"
+#include "partition.h"
+#include "arena.h"
+#include "saturate.h"
+#include "prewarm.h"
+#include "topology.h"
+#include "checkpoint_schedule.h"
+#include "buddy.h"
+#include "metrics.h"
 
 /**
  * @brief Main function implementing distributed counter simulation with DMR support.
@@ -37,90 +57,329 @@
  */
 int main(int argc, char *argv[])
 {
-    // Initialize MPI environment
-    MPI_Init(&argc, &argv);
+    // Initialize MPI environment; only the main thread makes MPI calls
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
 
     // Get MPI rank and size information
     int rank, size;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
 
-    // Construct full filepath for checkpoint files
-    char filepath[512];  // Increased buffer size for safety
-    snprintf(filepath, sizeof(filepath), "%s%s", FILEPATH, FILENAME);
+    // Problem size, checkpoint location and modes (defaults < environment < arguments)
+    Config cfg;
+    if (config_init(&cfg, argc, argv) != 0)
+    {
+        if (rank == 0)
+        {
+            fprintf(stderr, "Invalid configuration\n");
+        }
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    if (rank == 0)
+    {
+        config_print(&cfg);
+        if (cfg.verbosity >= 2)
+        {
+            printf("Increment kernel: %s, %d-bit counters\n", saturate_isa(), COUNTER_BITS);
+        }
+    }
+    trace_init(&cfg);
+    trace_set_context(rank, size);
+    bench_init(rank, &cfg);
+    metrics_init(&cfg);
+    hybrid_init(provided, rank, &cfg);
+    arena_init(&cfg);
+    buddy_init(rank, &cfg);
+
+    // Iterations between asynchronous fault-tolerance checkpoints (0 leaves them to the --mtbf schedule)
+    int ckpt_interval = cfg.ckpt_async_interval;
+
+    // Iterations since the last resize, which pace the periodic checkpoints; spawned ranks start from zero
+    int epoch_iteration = 0;
+
+    // Spawned processes get their slice from restart(): one over the spawned group alone would be thrown away,
+    // and the running ranks wait for them
+    MPI_Comm parent;
+    MPI_Comm_get_parent(&parent);
+    int spawned = parent != MPI_COMM_NULL;
+
+    // Iterations of the whole run, shown in the status output; spawned ranks take it over from the survivors
+    int iteration = 0;
+    int resync_iteration = spawned;
 
     // Calculate number of counters for this rank
-    int num_counters_local = dimension(rank, size, NUM_COUNTERS);
-    if (num_counters_local <= 0)
+    int64_t num_counters_local = spawned ? 0 : dimension(rank, size, cfg.num_counters);
+    if (!spawned && num_counters_local <= 0)
     {
-        fprintf(stderr, "Invalid number of local counters (%d) on rank %d\n", num_counters_local, rank);
+        fprintf(stderr, "Invalid number of local counters (%lld) on rank %d\n", (long long)num_counters_local, rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
     
     // Allocate and initialize local counters array
-    int *counters = init_counters(rank, num_counters_local);
+    counter_t *counters = spawned ? NULL : init_counters(rank, num_counters_local);
+    ActiveSet active = {NULL, 0, 0};
+    if (!spawned)
+    {
+        active_set_build(&active, counters, num_counters_local, cfg.max_counter_value);
+    }
+    if (!spawned && cfg.ckpt_mode == CKPT_MODE_DELTA)
+    {
+        delta_track_reset(num_counters_local);
+    }
 
-    // Initialize DMR with the provided arguments and restart callback
-    DMR_AUTO(dmr_init(argc, argv), (void)NULL, restart(rank, size, &counters, &num_counters_local, filepath), (void)NULL);
+    // Before the restart of spawned ranks, which takes over the schedule of the running ones
+    checkpoint_schedule_init(&cfg);
 
-    MPI_Comm comm = dmr_get_world_comm();
+    // Initialize DMR with the provided arguments and restart callback
+    trace_begin(TRACE_DMR_INIT);
+    DMR_AUTO(dmr_init(argc, argv), (void)NULL, restart(rank, size, &counters, &num_counters_local, &active, &cfg), (void)NULL);
 
-    // Set expansion parameters for rank 0 (coordinator)
-    if (rank == 0)
+    // Rank and size refer to the DMR communicator from here on
+    MPI_Comm comm = buddy_world_comm();
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    trace_set_context(rank, size);
+    trace_end(TRACE_DMR_INIT);
+    if (!counters)
     {
-        dmr_set_procs_next_expand(2);
-        dmr_set_procs_next_shrink(2);
+        fprintf(stderr, "Spawned rank %d received no counters from restart\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
 
     // Synchronize all processes before starting main computation
     MPI_Barrier(comm);
+    checkpoint_schedule_reset();
+
+    // Spawned ranks mirrored their slice in restart()
+    if (!spawned)
+    {
+        buddy_mirror(comm, rank, size, counters, num_counters_local, &cfg);
+    }
 
-    // Main computation loop - continue until all local counters reach maximum value
-    while (check_counters(counters, num_counters_local))
+    // Main computation loop - continue until the counters of every rank reach maximum value
+    double busy = 0.0;
+    for (;;)
     {
-        // Increment each local counter and perform computation
-        for (int i = 0; i < num_counters_local; i++)
+        // After a resize, every rank carries on from the iteration count of the most advanced one
+        if (resync_iteration)
+        {
+            MPI_Allreduce(MPI_IN_PLACE, &iteration, 1, MPI_INT, MPI_MAX, comm);
+            resync_iteration = 0;
+        }
+
+        // Global progress, reduced while this iteration computes
+        termination_start(comm, counters, &active, &cfg, busy);
+
+        // Increment each live counter and perform computation, dropping finished ones
+        trace_begin(TRACE_COMPUTE);
+        double compute_start = MPI_Wtime();
+        if (cfg.steal_chunk > 0)
+        {
+            // Idle ranks take chunks of live counters from busy ones
+            work_steal_iteration(comm, counters, num_counters_local, &active, &cfg);
+        }
+        else if (check_counters(&active) && active.count == num_counters_local)
+        {
+            // Every counter is live: each thread increments a contiguous run with the vector kernel
+            int threads = hybrid_threads();
+            int64_t live = 0;
+#pragma omp parallel for num_threads(threads) schedule(static) reduction(+ : live)
+            for (int t = 0; t < threads; t++)
+            {
+                int64_t lo = num_counters_local * t / threads;
+                int64_t hi = num_counters_local * (t + 1) / threads;
+                live += saturate_increment(counters + lo, hi - lo, cfg.max_counter_value);
+                for (int64_t i = lo; i < hi; i++)
+                {
+                    // Simulate computational work
+                    compute(&cfg);
+                }
+            }
+            delta_mark_all();
+
+            // Only iterations in which counters finish pay for a pass over the slice
+            if (live < active.count)
+            {
+                active_set_build(&active, counters, num_counters_local, cfg.max_counter_value);
+            }
+        }
+        else if (check_counters(&active))
+        {
+            // The thread team shares the live counters of this rank
+#pragma omp parallel for num_threads(hybrid_threads()) schedule(static)
+            for (int64_t k = 0; k < active.count; k++)
+            {
+                counters[active.live[k]]++;
+
+                // Simulate computational work
+                compute(&cfg);
+            }
+
+            // Dirty bits of neighbouring counters share a word, so marking stays serial
+            int64_t kept = 0;
+            for (int64_t k = 0; k < active.count; k++)
+            {
+                int i = active.live[k];
+                delta_mark_dirty(i);
+                if (counters[i] < cfg.max_counter_value)
+                {
+                    active.live[kept++] = i;
+                }
+            }
+            active.count = kept;
+        }
+        busy = MPI_Wtime() - compute_start;
+        trace_end(TRACE_COMPUTE);
+
+        // Every rank sees the same total, so all of them leave in the same iteration
+        GlobalProgress progress;
+        int64_t remaining = termination_finish(&progress);
+
+        // A rank failed: continue on the survivors with its slice rebuilt from the buddy replicas
+        if (buddy_failed())
+        {
+            recover(rank, &counters, &num_counters_local, &active, &cfg);
+            comm = buddy_world_comm();
+            MPI_Comm_rank(comm, &rank);
+            MPI_Comm_size(comm, &size);
+            busy = 0.0;
+            continue;
+        }
+        if (remaining == 0)
+        {
+            break;
+        }
+
+        // Rank 0 prints a summary of all counters, detail goes to the per-rank logs
+        iteration++;
+        status_report(comm, iteration, counters, num_counters_local, &cfg);
+        metrics_update(rank, size, iteration, &progress);
+
+        // Periodic fault-tolerance checkpoint, written while the next iterations run
+        epoch_iteration++;
+        if (ckpt_interval > 0 ? epoch_iteration % ckpt_interval == 0 : checkpoint_schedule_due())
         {
-            if (counters[i] < MAX_COUNTER_VALUE)
+            trace_begin(TRACE_ASYNC_BEGIN);
+            double ckpt_start = MPI_Wtime();
+            checkpoint_async_begin(rank, size, counters, num_counters_local, &cfg);
+            buddy_mirror(comm, rank, size, counters, num_counters_local, &cfg);
+            trace_end(TRACE_ASYNC_BEGIN);
+            if (ckpt_interval == 0)
             {
-                // Increment the counter if it hasn't reached maximum value
-                counters[i]++;
+                checkpoint_schedule_observe(comm, rank, MPI_Wtime() - ckpt_start);
             }
-            // Simulate computational work
-            compute();
+        }
+        else
+        {
+            checkpoint_async_progress();
         }
 
-        // Print current state of all local counters for debugging and monitoring
-        printf("Rank %d counters: ", rank);
-        for (int i = 0; i < num_counters_local; i++)
+        // DMR still holds the communicator that failed: no reconfiguration after a recovery
+        if (buddy_recovered())
         {
-            printf("%d ", counters[i]);
+            continue;
         }
-        printf("\n");
 
-        // Determine dynamic reconfiguration suggestion based on counter values
-        DMRSuggestion suggestion = SHOULD_STAY;
+        // Rank 0 runs the policy, whose model only it keeps, and every rank follows its plan:
+        // suggestion, processes, threads per rank and forecast expand
+        int plan[4] = {SHOULD_STAY, 0, hybrid_threads(), 0};
+        if (rank == 0)
+        {
+            PolicyMetrics metrics = {rank, size, hybrid_threads(), epoch_iteration, counters[0], progress};
+            ResizeDecision decision = resize_policy_decide(&metrics, &cfg);
 
-        // Expand when counters reach certain thresholds (more processes needed)
-        if (counters[0] == 3)
+            // Get the buffers of an expand ready while it is still a few iterations away
+            if (cfg.prewarm > 0 && decision.suggestion == SHOULD_STAY)
+            {
+                plan[3] = resize_policy_forecast(&metrics, &cfg, cfg.prewarm);
+            }
+
+            // Threads within the rank are resized before processes are spawned or killed
+            decision = hybrid_absorb(decision, rank, size, &cfg);
+            plan[0] = decision.suggestion;
+            plan[1] = decision.procs;
+            plan[2] = hybrid_threads();
+        }
+        MPI_Bcast(plan, 4, MPI_INT, 0, comm);
+        ResizeDecision decision = {(DMRSuggestion)plan[0], plan[1]};
+        hybrid_set_threads(plan[2]);
+        if (plan[3] > 0)
+        {
+            prewarm_expand(rank, size, plan[3], num_counters_local, &cfg);
+        }
+
+        // Rank 0 (coordinator) tells DMR how many processes to add or remove
+        if (rank == 0 && decision.suggestion == SHOULD_EXPAND)
         {
-            suggestion = SHOULD_EXPAND;
+            dmr_set_procs_next_expand(decision.procs);
         }
-        // Shrink when computation is nearly complete (fewer processes needed)
-        else if (counters[0] == 8)
+        else if (rank == 0 && decision.suggestion == SHOULD_SHRINK)
         {
-            suggestion = SHOULD_SHRINK;
+            dmr_set_procs_next_shrink(decision.procs);
         }
 
+        // Tell the in-memory redistribution which layout to prepare for
+        redistribute_set_target(decision.suggestion == SHOULD_EXPAND ? size + decision.procs :
+                                decision.suggestion == SHOULD_SHRINK ? size - decision.procs : size);
+
         // Synchronize all processes before checkpoint/reconfiguration
         // MPI_Barrier(comm);
 
         // Check for reconfiguration and perform checkpoint with cleanup on exit
-        DMR_AUTO(dmr_check(suggestion), checkpoint(rank, size, counters, num_counters_local, filepath), restart(rank, size, &counters, &num_counters_local, filepath), finalize(rank, counters));
+        trace_begin(TRACE_RECONFIG);
+        double reconfig_start = MPI_Wtime();
+        DMR_AUTO(dmr_check(decision.suggestion), checkpoint(rank, size, counters, num_counters_local, &cfg), restart(rank, size, &counters, &num_counters_local, &active, &cfg), finalize(rank, counters));
+
+        // Rank and size change when the reconfiguration resized the communicator
+        int old_size = size;
+        comm = buddy_world_comm();
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &size);
+        trace_set_context(rank, size);
+        trace_end(TRACE_RECONFIG);
+        bench_reconfig(rank, old_size, size, MPI_Wtime() - reconfig_start);
+        metrics_reconfig(rank, old_size, size, MPI_Wtime() - reconfig_start);
+
+        // Spawned ranks start the epoch from zero: keep the periodic checkpoints aligned
+        if (size != old_size)
+        {
+            if (rank == 0)
+            {
+                resize_policy_observe_reconfig(MPI_Wtime() - reconfig_start);
+            }
+            epoch_iteration = 0;
+            resync_iteration = 1;
+        }
     }
 
-    // Finalize DMR system
-    DMR_AUTO(dmr_finalize(), (void)NULL, (void)NULL, (void)NULL);
+    // Make sure the last periodic checkpoint is complete before leaving
+    checkpoint_async_wait();
+
+    compute_kernel_release();
+    active_set_free(&active);
+    work_steal_release();
+    if (cfg.ckpt_mode == CKPT_MODE_NODE)
+    {
+        node_tier_close(comm, &cfg);
+    }
+
+    // Phase imbalance across the final ranks, then the per-process event files
+    trace_summary(comm);
+    trace_close();
+    bench_close();
+    metrics_close();
+    status_close();
+    topology_release();
+    buddy_release();
+    partition_release();
+    arena_close();
+
+    // Finalize DMR system, unless a recovery left it on the failed communicator
+    if (!buddy_recovered())
+    {
+        DMR_AUTO(dmr_finalize(), (void)NULL, (void)NULL, (void)NULL);
+    }
 
     // Finalize MPI environment
     MPI_Finalize();
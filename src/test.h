@@ -19,21 +19,24 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <unistd.h>
-#include <math.h>
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <time.h>
 
 #include "dmr.h"
+#include "config.h"
+#include "active_set.h"
+#include "checkpoint_format.h"
+#include "counter.h"
 
-/** @brief Base directory path for checkpoint files */
-#define FILEPATH "/home/mderosso/dmr/DMR-test/checkpoints/"
-/** @brief Base filename for counter checkpoint files */
-#define FILENAME "counters"
-/** @brief Total number of counters distributed across all MPI ranks */
-#define NUM_COUNTERS 50
-/** @brief Maximum value each counter can reach before stopping */
-#define MAX_COUNTER_VALUE 10
-/** @brief Simulated computation time in seconds per counter increment */
-#define COMPUTE_TIME 2
+/** @brief Width in bytes of one fixed-width text record ("%11d\n") in MPI-IO checkpoints */
+#define CKPT_RECORD_WIDTH 12
+/** @brief Block size in bytes of the datatypes built by checkpoint_byte_type() */
+#define CKPT_IO_CHUNK (1 << 20)
+
+/** @brief Largest piece in bytes of a text checkpoint sent to a node leader at once */
+#define CKPT_TEXT_CHUNK (64 << 20)
 
 /**
  * @brief Computes offset for this rank in the global counter array.
@@ -49,8 +52,12 @@
  *
  * @note Returns 0 for invalid input parameters as a safe default
  * @note Formula accounts for remainder distribution among lower-ranked processes
+ * @note Reads the partition table of the layout (partition.h), built on first use
+ *       with exact integer arithmetic
+ * @note With --mapping=topology the slice of a rank is the block the mapping gives it
+ *       (see slice_block())
  */
-int offset(int rank, int size, int num_counters);
+int64_t offset(int rank, int size, int64_t num_counters);
 
 /**
  * @brief Calculates the number of counters assigned to this rank.
@@ -66,8 +73,22 @@ int offset(int rank, int size, int num_counters);
  *
  * @note Returns 0 for invalid input parameters as a safe default
  * @note Ranks with index < (num_counters % size) get one extra counter
+ * @note Reads the partition table of the layout (partition.h), like offset()
+ */
+int64_t dimension(int rank, int size, int64_t num_counters);
+
+/**
+ * @brief Returns the position of a rank's slice among the slices in global order.
+ *
+ * This is the writer index of the slice in the binary checkpoint format, rank
+ * itself unless the layout was remapped (see topology.h).
+ *
+ * @param rank MPI rank (0-based)
+ * @param size Total number of MPI ranks
+ * @param num_counters Total number of counters to distribute
+ * @return Block of the rank, 0 for invalid input parameters
  */
-int dimension(int rank, int size, int num_counters);
+int slice_block(int rank, int size, int64_t num_counters);
 
 /**
  * @brief Initializes the global counters file if it doesn't exist.
@@ -78,13 +99,14 @@ int dimension(int rank, int size, int num_counters);
  *
  * @param reconfig_count Number of reconfigurations that have occurred
  * @param rank Current MPI rank
- * @param filepath Full path to the counters file
+ * @param cfg Runtime configuration (checkpoint path, mode and counter count)
  *
  * @note This function is called before any checkpoint/restart operations
  * @note Only executed by rank 0 to ensure single-threaded file creation
- * @note Creates file with NUM_COUNTERS lines, each containing "0"
+ * @note Creates file with cfg->num_counters lines, each containing "0", or a binary
+ *       checkpoint of zeros when the mode writes binary files
  */
-void init_data(int reconfig_count, int rank, char *filepath);
+void init_data(int reconfig_count, int rank, const Config *cfg);
 
 /**
  * @brief Allocates and initializes local counters array for this rank.
@@ -97,28 +119,32 @@ void init_data(int reconfig_count, int rank, char *filepath);
  * @param num_counters Number of counters to allocate for this rank
  * @return Pointer to allocated and initialized counters array
  *
- * @note The returned pointer must be freed using free() when no longer needed
+ * @note The returned pointer is released by finalize(); restart() may replace it by a
+ *       mapping of the checkpoint (see counter_map.h), so it is not passed to free() directly
+ * @note The array is an arena buffer (see arena.h), reused across reconfigurations; its
+ *       pages are first touched by the threads of the counter loop
  * @note Program will abort on memory allocation failure or invalid parameters
  * @note All counters are initialized to 0
+ * @note Counters are counter_t, whose width is fixed at build time (see counter.h)
+ * @note Aborts if num_counters does not fit in an MPI count (INT_MAX)
  */
-int *init_counters(int rank, int num_counters);
+counter_t *init_counters(int rank, int64_t num_counters);
 
 /**
  * @brief Checks if any local counter is still below the maximum value.
  *
  * This function determines whether the computation should continue by checking
- * if any of the local counters has not yet reached MAX_COUNTER_VALUE.
- * Includes input validation for safety.
+ * if any of the local counters has not yet reached the maximum value. The live
+ * counters are tracked by the active set, so the check takes constant time.
  *
- * @param counters Pointer to the local counters array
- * @param num_counters Number of counters in the array
+ * @param active Active set of the local counters
  * @return 1 if any counter is below the maximum value (continue computation),
  *         0 if all counters have reached maximum or on invalid input (stop computation)
  *
- * @note Returns 0 (stop) for NULL pointer or invalid parameters as safe default
+ * @note Returns 0 (stop) for NULL pointer as safe default
  * @note Used to control the main computation loop termination
  */
-int check_counters(int *counters, int num_counters);
+int check_counters(const ActiveSet *active);
 
 /**
  * @brief Loads counter values from checkpoint file after a reconfiguration.
@@ -128,52 +154,190 @@ int check_counters(int *counters, int num_counters);
  * for this rank and reads the corresponding counter values. Includes comprehensive
  * error checking and data validation.
  *
+ * The file format is detected from its first bytes. Binary checkpoints are read with
+ * a single seek to CKPT_HEADER_SIZE + offset * sizeof(int32_t) and one read of the
+ * whole slice, and the CRC32C of its blocks is verified by each rank. Compressed
+ * checkpoints are decoded block by block with compressed_restore(), reading only the
+ * blocks that overlap the slice. Any other file is parsed as the legacy
+ * one-value-per-line text format. With cfg->mmap_restart, the slice of
+ * a binary checkpoint is mapped copy-on-write instead of read (see counter_map.h),
+ * and *counters then points into the mapping.
+ *
+ * A checkpoint is only used if every rank loaded its slice, all values are within
+ * [0, max_counter_value] and the global checksum matches. Otherwise the previous
+ * generation (see checkpoint_commit.h) is read the same way.
+ *
+ * The ranks first classify the transition from the layout of their last checkpoint().
+ * If every rank kept its rank and the size is unchanged, nothing is read: the counters
+ * and the active set in memory are the checkpoint. In a pure expand or shrink, where
+ * the surviving ranks kept their rank, every survivor keeps the part of its old slice
+ * that lies in the new one and reads only the rest, unless the file does not hold the
+ * values in memory (CKPT_MODE_MEMORY, CKPT_MODE_DELTA) or the slice is mapped.
+ *
  * @param rank Current MPI rank
  * @param size Total number of MPI ranks
- * @param counters Pointer to the local counters array to populate
+ * @param counters Pointer to the local counters array to populate, replaced when the
+ *                 layout changes or the slice is mapped
  * @param num_counters Number of counters this rank should manage
- * @param filepath Path to the global checkpoint file
+ * @param active Active set, rebuilt from the loaded counters
+ * @param cfg Runtime configuration; with CKPT_MODE_MEMORY the counters are first restored
+ *            with redistribute_restore() and the file is only read as a fallback;
+ *            with CKPT_MODE_DELTA the deltas on top of the binary base are replayed
  *
- * @note Counter values are validated and reset to 0 if outside valid range
- * @note Program will abort on file I/O errors or invalid parameters
+ * @note Program will abort on invalid parameters or if neither generation verifies
+ * @note Collective over buddy_world_comm()
  * @note Uses offset() function to determine correct file position for this rank
  */
-void restart(int rank, int size, int **counters, int *num_counters, char *filepath);
+void restart(int rank, int size, counter_t **counters, int64_t *num_counters, ActiveSet *active, const Config *cfg);
 
 /**
- * @brief Saves local counters and creates aggregated checkpoint file.
+ * @brief Continues on the survivors of a process failure, rebuilding the lost slices from buddy replicas.
  *
- * This function implements a two-phase checkpointing strategy:
- * 1. Each rank saves its local counters to a rank-specific file
- * 2. Rank 0 aggregates all rank-specific files into a global checkpoint file
+ * The failed communicator is shrunk to its survivors, the counters are
+ * repartitioned over them with offset()/dimension() and every new slice is
+ * filled from the survivors' counters and the replicas of the lost ranks
+ * (see buddy.h). The checkpoint in flight, if any, is dropped, the next delta
+ * checkpoint holds every counter, and the new slices are mirrored again.
+ *
+ * @param rank Rank of this process before the failure
+ * @param counters Pointer to the local counters array, replaced by the new slice
+ * @param num_counters Pointer to the local counter count, updated
+ * @param active Active set, rebuilt from the new slice
+ * @param cfg Runtime configuration
+ *
+ * @note Collective over the survivors of buddy_world_comm(); rank 0 reports the recovery
+ */
+void recover(int rank, counter_t **counters, int64_t *num_counters, ActiveSet *active, const Config *cfg);
+
+/**
+ * @brief Saves local counters into the global checkpoint file.
  *
- * The process is synchronized using MPI barriers to ensure data consistency.
+ * The counters in memory are marked as the checkpoint until the next restart(),
+ * then the strategy of the checkpoint mode writes and commits the global file.
  * This approach allows for fault-tolerant state preservation during reconfigurations.
  *
  * @param rank Current MPI rank
  * @param size Total number of MPI ranks
  * @param counters Pointer to the local counters array
  * @param num_counters Number of counters in the local array
- * @param filepath Base path for the checkpoint files
+ * @param cfg Runtime configuration; its checkpoint mode selects the strategy:
+ *            CKPT_MODE_MPIIO delegates to checkpoint_mpiio() and CKPT_MODE_BINARY to
+ *            checkpoint_binary(); CKPT_MODE_MEMORY writes no file and only stashes the
+ *            counters with redistribute_stash(); CKPT_MODE_DELTA delegates to
+ *            checkpoint_delta()
+ *
+ * CKPT_MODE_TEXT delegates to checkpoint_text().
+ *
+ * @note Waits for any asynchronous checkpoint in flight (checkpoint_async_wait()) first
+ */
+void checkpoint(int rank, int size, counter_t *counters, int64_t num_counters, const Config *cfg);
+
+/**
+ * @brief Writes the text checkpoint through one leader per node.
+ *
+ * Every rank formats its slice as one decimal per line and finds its byte offset
+ * in the file with an exclusive scan in the global order of the slices. The ranks
+ * of a node (MPI_COMM_TYPE_SHARED) send their text to the lowest rank of the node
+ * in pieces of at most CKPT_TEXT_CHUNK bytes, and the node leaders alone open the
+ * staged file with MPI-IO and write every piece at its offset, so that no rank
+ * handles more than its node's data and the file sees one client per node. The
+ * leaders pass their count as the cb_nodes hint, so that MPI-IO aggregation
+ * matches them. The staged file is synced and committed once every leader has
+ * closed it.
+ *
+ * @param rank Current MPI rank
+ * @param size Total number of MPI ranks
+ * @param counters Pointer to the local counters array
+ * @param num_counters Number of counters in the local array
+ * @param cfg Runtime configuration (checkpoint path and global counter count)
  *
- * @note Uses MPI barriers for synchronization between phases
- * @note Rank-specific files are temporary and aggregated by rank 0
- * @note Creates files with .XXX suffix for individual ranks, then consolidates
+ * @note Collective over buddy_world_comm(): every rank must call it
+ * @note The file is the same as the one rank 0 used to merge from per-rank files
  */
-void checkpoint(int rank, int size, int *counters, int num_counters, char *filepath);
+void checkpoint_text(int rank, int size, counter_t *counters, int64_t num_counters, const Config *cfg);
 
 /**
- * @brief Simulates computational work with a time delay.
+ * @brief Writes local counters directly into the global checkpoint using collective MPI-IO.
+ *
+ * Every rank formats its slice as fixed-width text records of CKPT_RECORD_WIDTH bytes
+ * and writes it at its offset() in the shared file with a single MPI_File_write_at_all.
+ * No per-rank temporary files and no rank-0 aggregation pass are involved. Since each
+ * record is a right-aligned decimal followed by a newline, the resulting file is still
+ * readable line by line by restart().
+ *
+ * @param rank Current MPI rank
+ * @param size Total number of MPI ranks
+ * @param counters Pointer to the local counters array
+ * @param num_counters Number of counters in the local array
+ * @param cfg Runtime configuration (checkpoint path and global counter count)
+ *
+ * @note Collective over buddy_world_comm(): every rank must call it
+ * @note The staged file is resized to exactly cfg->num_counters records, then committed
+ */
+void checkpoint_mpiio(int rank, int size, counter_t *counters, int64_t num_counters, const Config *cfg);
+
+/**
+ * @brief Writes local counters into a binary checkpoint using collective MPI-IO.
+ *
+ * Rank 0 writes the CheckpointHeader, carrying the reconfiguration epoch and the
+ * checksum reduced from every rank's partial ckpt_checksum(). Every rank writes its
+ * slice as packed int32 values at CKPT_HEADER_SIZE + offset * sizeof(int32_t), and
+ * the CRC32C of its blocks at ckpt_crc_position(). The staged file is synced and
+ * committed once every rank has closed it.
+ *
+ * @param rank Current MPI rank
+ * @param size Total number of MPI ranks
+ * @param counters Pointer to the local counters array
+ * @param num_counters Number of counters in the local array
+ * @param cfg Runtime configuration (checkpoint path and global counter count)
+ *
+ * @note Collective over buddy_world_comm(): every rank must call it
+ * @note Increments the reconfiguration epoch recorded in the header
+ */
+void checkpoint_binary(int rank, int size, counter_t *counters, int64_t num_counters, const Config *cfg);
+
+/**
+ * @brief Advances and returns the reconfiguration epoch stored in checkpoint headers.
+ *
+ * The epoch is restored from the header by restart(), so spawned ranks continue
+ * the sequence of the ranks that wrote the last checkpoint.
+ *
+ * @return Epoch of the checkpoint about to be written
+ */
+uint64_t checkpoint_next_epoch(void);
+
+/**
+ * @brief Returns the epoch of the last checkpoint written or loaded.
+ *
+ * @return Current checkpoint epoch
+ */
+uint64_t checkpoint_epoch(void);
+
+/**
+ * @brief Builds a datatype spanning a byte count that may exceed INT_MAX.
+ *
+ * MPI counts are ints, so large slices are described as whole CKPT_IO_CHUNK blocks
+ * followed by the remaining bytes, and transferred with a count of 1.
+ *
+ * @param bytes Number of contiguous bytes
+ * @return Committed datatype, to be released with MPI_Type_free()
+ */
+MPI_Datatype checkpoint_byte_type(uint64_t bytes);
+
+/**
+ * @brief Simulates computational work with the configured compute kernel.
+ *
+ * This function represents actual computational work in the simulation. The
+ * default kernel introduces a configurable sleep delay; the stream and fma kernels
+ * put real memory-bandwidth or floating-point load on the CPU (compute_kernel.h).
  *
- * This function represents actual computational work in the simulation by
- * introducing a configurable sleep delay. In a real application, this would
- * be replaced with actual computational algorithms.
+ * @param cfg Runtime configuration (kernel, work_size, compute_time for the sleep kernel)
  *
- * @note Sleep duration is controlled by COMPUTE_TIME constant
+ * @note Sub-second delays are supported
  * @note Helps simulate realistic timing for checkpoint/restart testing
  * @note Called once per counter increment to simulate work load
  */
-void compute();
+void compute(const Config *cfg);
 
 /**
  * @brief Safely deallocates memory for counters array before process termination.
@@ -189,6 +353,6 @@ void compute();
  * @note Should be called before process termination to prevent memory leaks
  * @note Part of the cleanup process in DMR_AUTO finalization
  */
-void finalize(int rank, int *counters);
+void finalize(int rank, counter_t *counters);
 
 #endif /* TEST_H */
@@ -12,8 +12,47 @@
  */
 
 #include "test.h"
+#include "redistribute.h"
+#include "async_checkpoint.h"
+#include "delta_checkpoint.h"
+#include "compute_kernel.h"
+#include "trace.h"
+#include "bench.h"
+#include "status.h"
+#include "work_steal.h"
+#include "node_tier.h"
+#include "counter_map.h"
+#include "compressed_checkpoint.h"
+#include "checkpoint_commit.h"
+#include "partition.h"
+#include "arena.h"
+#include "hybrid.h"
+#include "topology.h"
+#include "checkpoint_schedule.h"
+#include "buddy.h"
+#include "metrics.h"
 
-int offset(int rank, int size, int num_counters)
+/** @brief Reconfiguration epoch of the last binary checkpoint written or loaded */
+static uint64_t ckpt_epoch = 0;
+
+/** @brief Layout the counters in memory had when checkpoint() last saved them; valid until the next restart() */
+static struct
+{
+    int valid;
+    int rank;
+    int size;
+} held = {0, -1, 0};
+
+/** @brief How the layout changed between the last checkpoint and restart() */
+typedef enum
+{
+    TRANSITION_UNCHANGED, /**< Same ranks, same size: the counters in memory are the checkpoint */
+    TRANSITION_EXPAND,    /**< Ranks added, survivors kept their rank */
+    TRANSITION_SHRINK,    /**< Ranks removed, survivors kept their rank */
+    TRANSITION_RELOAD     /**< Anything else: every rank loads its whole slice */
+} RestartTransition;
+
+int64_t offset(int rank, int size, int64_t num_counters)
 {
     // Input validation - ensure all parameters are within valid ranges
     if (size <= 0 || rank < 0 || rank >= size || num_counters <= 0)
@@ -21,12 +60,12 @@ int offset(int rank, int size, int num_counters)
         return 0;  // Return safe default for invalid inputs
     }
     
-    // Calculate the offset using integer division and modulo for load balancing
-    // Formula accounts for remainder distribution among lower-ranked processes
-    return rank * floor((double)num_counters / size) + (rank < num_counters % size ? rank : num_counters % size);
+    // Slice starts are a prefix sum over the blocks, built once per layout
+    const Partition *p = partition_get(size, num_counters);
+    return p->starts[partition_block(p, rank)];
 }
 
-int dimension(int rank, int size, int num_counters)
+int64_t dimension(int rank, int size, int64_t num_counters)
 {
     // Input validation - ensure all parameters are within valid ranges
     if (size <= 0 || rank < 0 || rank >= size || num_counters <= 0)
@@ -34,230 +73,903 @@ int dimension(int rank, int size, int num_counters)
         return 0;  // Return safe default for invalid inputs
     }
     
-    // Calculate base number of counters per rank plus one extra for remainder distribution
-    return floor((double)num_counters / size) + (rank < num_counters % size ? 1 : 0);
+    // Distance to the start of the next slice: one extra counter for the lowest blocks
+    const Partition *p = partition_get(size, num_counters);
+    int block = partition_block(p, rank);
+    return p->starts[block + 1] - p->starts[block];
 }
 
-void init_data(int reconfig_count, int rank, char *filepath)
+int slice_block(int rank, int size, int64_t num_counters)
+{
+    if (size <= 0 || rank < 0 || rank >= size || num_counters <= 0)
+    {
+        return 0;
+    }
+    return partition_block(partition_get(size, num_counters), rank);
+}
+
+void init_data(int reconfig_count, int rank, const Config *cfg)
 {
     // Initialize counters file only on first run and only by root process
     if (reconfig_count == 0 && rank == 0)
     {
-        FILE *f = fopen(filepath, "w");
+        char staged[CKPT_PATH_SIZE];
+        checkpoint_staged_path(staged, sizeof(staged), cfg);
+        FILE *f = fopen(staged, "w");
         if (!f)
         {
-            fprintf(stderr, "Could not open file %s for writing\n", filepath);
+            fprintf(stderr, "Could not open file %s for writing\n", staged);
             MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
         }
 
-        // Initialize all counters to zero in the global file
-        for (int i = 0; i < NUM_COUNTERS; i++)
+        int ok = 1;
+        if (cfg->ckpt_mode == CKPT_MODE_BINARY || cfg->ckpt_mode == CKPT_MODE_DELTA || cfg->ckpt_mode == CKPT_MODE_NODE ||
+            cfg->ckpt_mode == CKPT_MODE_COMPRESSED)
+        {
+            // All-zero array: the checksum of zeros is zero, and untouched calloc pages cost no memory
+            int32_t *zeros = calloc(cfg->num_counters, sizeof(int32_t));
+            ok = zeros && ckpt_write_binary(f, zeros, cfg->num_counters, 0, 0) == 0;
+            free(zeros);
+        }
+        else
         {
-            fprintf(f, "%d\n", 0); // Write each counter value on a separate line
+            // Initialize all counters to zero in the global file
+            for (int64_t i = 0; ok && i < cfg->num_counters; i++)
+            {
+                ok = fprintf(f, "%d\n", 0) > 0; // Write each counter value on a separate line
+            }
+        }
+        ok = fflush(f) == 0 && fsync(fileno(f)) == 0 && ok;
+        ok = fclose(f) == 0 && ok;
+
+        // A fresh run has no previous generation: a file left by an older run must not become one
+        remove(cfg->filepath);
+        if (!ok || checkpoint_commit_file(cfg) != 0)
+        {
+            fprintf(stderr, "Failed to write file %s\n", cfg->filepath);
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
         }
-        fclose(f);
     }
 }
 
-int *init_counters(int rank, int num_counters)
+counter_t *init_counters(int rank, int64_t num_counters)
 {
-    // Input validation - ensure positive number of counters
-    if (num_counters <= 0)
+    // Input validation - ensure positive number of counters that fits an MPI count
+    if (num_counters <= 0 || num_counters > INT_MAX)
     {
-        fprintf(stderr, "Invalid number of counters (%d) on rank %d\n", num_counters, rank);
+        fprintf(stderr, "Invalid number of counters (%lld) on rank %d\n", (long long)num_counters, rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
     
-    // Allocate memory for the counters array
-    int *counters = malloc(num_counters * sizeof(int));
-    if (!counters)
-    {
-        fprintf(stderr, "Memory allocation failed on rank %d\n", rank);
-        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
-    }
-    
-    // Initialize all counters to zero
-    for (int i = 0; i < num_counters; i++)
+    // Reuse a buffer of an earlier epoch: its pages are already faulted in
+    counter_t *counters = arena_acquire((size_t)num_counters * sizeof(counter_t));
+
+    // Zeroed by the threads of the counter loop, with its schedule: each page lands on the NUMA node of its thread
+#pragma omp parallel for num_threads(hybrid_threads()) schedule(static)
+    for (int64_t i = 0; i < num_counters; i++)
     {
         counters[i] = 0;
     }
 
-    printf("Rank %d initialized %d counters.\n", rank, num_counters);
+    printf("Rank %d initialized %lld counters.\n", rank, (long long)num_counters);
 
     return counters;
 }
 
-int check_counters(int *counters, int num_counters)
+/**
+ * @brief Releases a counters array, whether taken from the arena by init_counters() or mapped by restart().
+ */
+static void release_counters(counter_t *counters)
+{
+    if (!counter_map_release(counters))
+    {
+        arena_release(counters);
+    }
+}
+
+int check_counters(const ActiveSet *active)
 {
-    // Input validation - ensure valid pointer and positive count
-    if (!counters || num_counters <= 0)
+    // Input validation - ensure valid pointer
+    if (!active)
     {
         return 0;  // Return safe default (stop execution) for invalid inputs
     }
-    
-    // Check if any counter is still below the maximum value
-    for (int i = 0; i < num_counters; i++)
+
+    // Continue computation while any local counter is below max value
+    return active->count > 0;
+}
+
+/**
+ * @brief Classifies the layout change collectively, from the layout every process last checkpointed with.
+ */
+static RestartTransition restart_transition(MPI_Comm comm, int new_rank, int new_size)
+{
+    // Spawned processes hold nothing: they neither break "unchanged" nor "kept its rank"
+    int local[3] = {held.valid && held.rank == new_rank && held.size == new_size, !held.valid || held.rank == new_rank,
+                    held.valid ? -held.size : 0};
+    int global[3];
+    MPI_Allreduce(local, global, 3, MPI_INT, MPI_MIN, comm);
+    int old_size = -global[2];
+
+    if (global[0])
+    {
+        return TRANSITION_UNCHANGED;
+    }
+    if (old_size == 0 || !global[1])
     {
-        if (counters[i] < MAX_COUNTER_VALUE)
+        return TRANSITION_RELOAD;
+    }
+    return new_size > old_size ? TRANSITION_EXPAND : TRANSITION_SHRINK;
+}
+
+/**
+ * @brief Reads (or maps, when mapped is set) this rank's slice from a binary checkpoint and verifies its CRCs.
+ *
+ * The keep_count counters starting at keep_first are already in place and are not read.
+ *
+ * @return 0 on success, -1 if the slice cannot be read or fails its CRCs
+ */
+static int restart_binary(int rank, FILE *f, const CheckpointHeader *header, counter_t **counters, int64_t num_counters, int64_t first,
+                          int64_t keep_first, int64_t keep_count, int mapped)
+{
+    // Copy-on-write mapping of the slice: nothing is copied until a counter is incremented
+    counter_t *slice = mapped ? counter_map_slice(fileno(f), first, num_counters) : NULL;
+    if (slice)
+    {
+        release_counters(*counters);
+        *counters = slice;
+        if (ckpt_verify_slice(f, header, (const int32_t *)slice, first, num_counters) != 0)
         {
-            return 1; // Continue computation if any local counter is below max value
+            fprintf(stderr, "CRC mismatch in binary checkpoint on rank %d\n", rank);
+            return -1;
         }
+        return 0;
     }
-    return 0; // Stop computation - all local counters have reached maximum value
+
+    // Fixed-width elements: seek straight to the parts around the kept range and read each in one call
+    int64_t end = first + num_counters;
+    int64_t parts[2][2] = {{first, keep_count > 0 ? keep_first : end}, {keep_count > 0 ? keep_first + keep_count : end, end}};
+    for (int p = 0; p < 2; p++)
+    {
+        int64_t count = parts[p][1] - parts[p][0];
+        if (count <= 0)
+        {
+            continue;
+        }
+
+        // Narrow counters are read as int32 values first, the others in place
+        counter_t *part = *counters + (parts[p][0] - first);
+        int32_t *target = counter_stage(part, count);
+        const char *error = NULL;
+        if (fseeko(f, CKPT_HEADER_SIZE + (off_t)parts[p][0] * (off_t)sizeof(int32_t), SEEK_SET) != 0 ||
+            fread(target, sizeof(int32_t), count, f) != (size_t)count)
+        {
+            error = "Failed to read counter slice";
+        }
+        else if (ckpt_verify_slice(f, header, target, parts[p][0], count) != 0)
+        {
+            error = "CRC mismatch in binary checkpoint";
+        }
+        if (counter_stage_commit(part, target, count) != 0 && !error)
+        {
+            error = "Counter value out of range in binary checkpoint";
+        }
+        if (error)
+        {
+            fprintf(stderr, "%s on rank %d\n", error, rank);
+            return -1;
+        }
+    }
+    return 0;
 }
 
-void restart(int rank, int size, int **counters, int *num_counters, char *filepath)
+/**
+ * @brief Reads this rank's slice from a one-value-per-line text checkpoint, except the kept range.
+ *
+ * @return 0 on success, -1 if the file is too short
+ */
+static int restart_text(int rank, FILE *f, counter_t *counters, int64_t num_counters, int64_t first, int64_t keep_first,
+                        int64_t keep_count)
+{
+    char line[256];
+
+    // Skip lines belonging to previous ranks in the file
+    for (int64_t i = 0; i < first; i++)
+    {
+        if (!fgets(line, sizeof(line), f))
+        {
+            fprintf(stderr, "Error skipping lines on rank %d\n", rank);
+            return -1;
+        }
+    }
+
+    // Read local counter values
+    for (int64_t i = 0; i < num_counters; i++)
+    {
+        if (!fgets(line, sizeof(line), f))
+        {
+            fprintf(stderr, "Failed to read counter line on rank %d\n", rank);
+            return -1;
+        }
+        if (first + i < keep_first || first + i >= keep_first + keep_count)
+        {
+            // A value the counters cannot hold must not wrap around into a valid one
+            int value = atoi(line);
+            if (value < 0 || value > COUNTER_MAX)
+            {
+                fprintf(stderr, "Invalid counter value %d on rank %d\n", value, rank);
+                return -1;
+            }
+            counters[i] = (counter_t)value;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Loads this rank's slice from one generation of the global checkpoint.
+ *
+ * Every rank takes part in the same collectives whatever happens locally, and
+ * the generation is only accepted if it verifies on every rank: CRCs or block
+ * CRCs, values within [0, max_counter_value] and the global checksum. The
+ * keep_count counters starting at keep_first already hold the values of this
+ * generation and are not read again.
+ *
+ * @return 1 with *epoch set if the generation verified on every rank, 0 otherwise
+ */
+static int restart_generation(int rank, const char *path, counter_t **counters, int64_t num_counters, int64_t first,
+                              int64_t keep_first, int64_t keep_count, const Config *cfg, uint64_t *epoch)
+{
+    MPI_Comm comm = buddy_world_comm();
+
+    // Kind of file: -1 missing, 0 text, 1 binary, 2 compressed
+    FILE *f = fopen(path, "rb");
+    CheckpointHeader header;
+    CompressedHeader compressed;
+    int kind = -1;
+    if (f)
+    {
+        kind = ckpt_read_compressed_header(f, &compressed) == 0 ? 2 : ckpt_read_header(f, &header) == 0 ? 1 : 0;
+    }
+
+    // Every rank must see the same kind, or their collectives would not match
+    int kinds[2] = {kind, -kind};
+    MPI_Allreduce(MPI_IN_PLACE, kinds, 2, MPI_INT, MPI_MAX, comm);
+    if (kinds[0] != -kinds[1] || kind < 0)
+    {
+        if (f)
+        {
+            fclose(f);
+        }
+        return 0;
+    }
+
+    int status = 0;
+    uint64_t expected = 0;
+    if (kind == 2)
+    {
+        // Only the blocks overlapping the slice are read and decoded
+        status = compressed_restore(rank, f, &compressed, *counters, first, num_counters, keep_first, keep_count, cfg);
+        expected = compressed.checksum;
+        *epoch = compressed.epoch;
+    }
+    else if (kind == 1)
+    {
+        // The header is the same on every rank, and so is the outcome of this check
+        if (ckpt_header_validate(&header) != 0 || header.num_counters != (uint64_t)cfg->num_counters)
+        {
+            if (rank == 0)
+            {
+                fprintf(stderr, "Incompatible binary checkpoint (version %u, %llu counters)\n", header.version,
+                        (unsigned long long)header.num_counters);
+            }
+            fclose(f);
+            return 0;
+        }
+        status = restart_binary(rank, f, &header, counters, num_counters, first, keep_first, keep_count, cfg->mmap_restart);
+        expected = header.checksum;
+        *epoch = header.epoch;
+    }
+    else
+    {
+        status = restart_text(rank, f, *counters, num_counters, first, keep_first, keep_count);
+        *epoch = 0;
+    }
+    fclose(f);
+
+    // Counter values out of range can only come from a corrupted file
+    for (int64_t i = 0; status == 0 && i < num_counters; i++)
+    {
+        if ((int64_t)(*counters)[i] < 0 || (*counters)[i] > cfg->max_counter_value)
+        {
+            fprintf(stderr, "Invalid counter value %d on rank %d\n", (int)(*counters)[i], rank);
+            status = -1;
+        }
+    }
+
+    // Agree on the outcome and verify the checksum collectively before trusting the values
+    uint64_t local_sum = counter_checksum(*counters, first, num_counters);
+    uint64_t global_sum = 0;
+    MPI_Allreduce(&local_sum, &global_sum, 1, MPI_UINT64_T, MPI_SUM, comm);
+    MPI_Allreduce(MPI_IN_PLACE, &status, 1, MPI_INT, MPI_MIN, comm);
+    if (status == 0 && kind > 0 && global_sum != expected)
+    {
+        if (rank == 0)
+        {
+            fprintf(stderr, "Checksum mismatch in checkpoint %s\n", path);
+        }
+        status = -1;
+    }
+    return status == 0;
+}
+
+void restart(int rank, int size, counter_t **counters, int64_t *num_counters, ActiveSet *active, const Config *cfg)
 {
     printf("Rank %d is restarting. Loading counters from file...\n", rank);
 
-    MPI_Comm comm = dmr_get_world_comm();
+    MPI_Comm comm = buddy_world_comm();
 
     int new_rank, new_size;
     MPI_Comm_rank(comm, &new_rank);
     MPI_Comm_size(comm, &new_size);
+    trace_set_context(new_rank, new_size);
+    trace_begin(TRACE_RESTART);
+    bench_begin(BENCH_RESTART);
+    metrics_begin(METRICS_RESTART);
+
+    // The counters in memory are only the checkpoint until this restart
+    RestartTransition transition = restart_transition(comm, new_rank, new_size);
+    checkpoint_schedule_resize(comm, new_rank, size);
+    int holds = held.valid;
+    held.valid = 0;
+
+    // Nothing moved: the counters and the active set in memory are what was just checkpointed
+    if (transition == TRANSITION_UNCHANGED)
+    {
+        if (cfg->ckpt_mode == CKPT_MODE_MEMORY)
+        {
+            redistribute_discard();
+        }
+        if (new_rank == 0 && cfg->verbosity >= 1)
+        {
+            printf("Layout unchanged on %d ranks, counters kept in memory\n", new_size);
+        }
+        buddy_mirror(comm, new_rank, new_size, *counters, *num_counters, cfg);
+        trace_end(TRACE_RESTART);
+        bench_end(BENCH_RESTART, comm);
+        metrics_end(METRICS_RESTART);
+        return;
+    }
+
+    // Old mapping to every process, then the new layout's, before any new slice is looked up
+    topology_remap(comm, transition == TRANSITION_EXPAND || transition == TRANSITION_SHRINK, cfg);
+
+    // Survivors of a pure expand or shrink keep the part of their old slice that is in the new one,
+    // as long as the file holds the same values (not in memory and delta modes) and is not mapped
+    int64_t keep_first = 0, keep_count = 0;
+    int keep = holds && (transition == TRANSITION_EXPAND || transition == TRANSITION_SHRINK) &&
+               cfg->ckpt_mode != CKPT_MODE_MEMORY && cfg->ckpt_mode != CKPT_MODE_DELTA && !(cfg->mmap_restart && COUNTER_IS_INT32);
 
     if (new_rank != rank || new_size != size)
     {
-        free(*counters);
-        *num_counters = dimension(new_rank, new_size, NUM_COUNTERS);
+        int64_t old_first = offset(rank, size, cfg->num_counters);
+        int64_t old_end = old_first + *num_counters;
+        counter_t *old = *counters;
+        *num_counters = dimension(new_rank, new_size, cfg->num_counters);
         *counters = init_counters(new_rank, *num_counters);
+
+        int64_t new_first = offset(new_rank, new_size, cfg->num_counters);
+        int64_t lo = old_first > new_first ? old_first : new_first;
+        int64_t hi = old_end < new_first + *num_counters ? old_end : new_first + *num_counters;
+        if (keep && hi > lo)
+        {
+            memcpy(*counters + (lo - new_first), old + (lo - old_first), (size_t)(hi - lo) * sizeof(counter_t));
+            keep_first = lo;
+            keep_count = hi - lo;
+        }
+        release_counters(old);
         rank = new_rank;
         size = new_size;
     }
     
     // Input validation - ensure all required parameters are valid
-    if (!*counters || !filepath || *num_counters <= 0)
+    if (!*counters || !cfg || *num_counters <= 0)
     {
         fprintf(stderr, "Invalid parameters for restart on rank %d\n", rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
+
+    // In-memory mode: pull the slice from the previous owners, no file access
+    trace_begin(TRACE_RESTART_READ);
+    if (cfg->ckpt_mode == CKPT_MODE_MEMORY)
+    {
+        if (redistribute_restore(rank, size, *counters, *num_counters, cfg))
+        {
+            active_set_build(active, *counters, *num_counters, cfg->max_counter_value);
+            trace_end(TRACE_RESTART_READ);
+            buddy_mirror(comm, rank, size, *counters, *num_counters, cfg);
+            trace_end(TRACE_RESTART);
+            bench_end(BENCH_RESTART, comm);
+            metrics_end(METRICS_RESTART);
+            return;
+        }
+        if (rank == 0)
+        {
+            fprintf(stderr, "Warning: In-memory counters incomplete, falling back to %s\n", cfg->filepath);
+        }
+    }
+
+    // Node tier: read the slices from node-local files, the drained global file otherwise
+    if (cfg->ckpt_mode == CKPT_MODE_NODE)
+    {
+        uint64_t epoch = node_tier_restore(rank, size, *counters, *num_counters, cfg);
+        if (epoch > 0)
+        {
+            ckpt_epoch = epoch;
+            active_set_build(active, *counters, *num_counters, cfg->max_counter_value);
+            trace_end(TRACE_RESTART_READ);
+            trace_end(TRACE_RESTART);
+            bench_end(BENCH_RESTART, comm);
+            metrics_end(METRICS_RESTART);
+            return;
+        }
+        if (rank == 0)
+        {
+            printf("Node checkpoint tier incomplete, reading %s\n", cfg->filepath);
+        }
+    }
     
-    // Open the global checkpoint file for reading
-    FILE *f = fopen(filepath, "r");
-    if (!f)
+    // The slice position is a function of the global counter count
+    int64_t first = offset(rank, size, cfg->num_counters);
+
+    // The committed checkpoint first, the previous generation if it does not verify
+    char paths[2][CKPT_PATH_SIZE];
+    snprintf(paths[0], sizeof(paths[0]), "%s", cfg->filepath);
+    checkpoint_previous_path(paths[1], sizeof(paths[1]), cfg);
+    uint64_t epoch = 0;
+    int loaded = 0;
+    for (int g = 0; g < 2 && !loaded; g++)
     {
-        fprintf(stderr, "Could not open file %s on rank %d\n", filepath, rank);
+        if (g > 0)
+        {
+            if (rank == 0)
+            {
+                fprintf(stderr, "Warning: Checkpoint %s is missing or corrupted, falling back to %s\n", paths[g - 1], paths[g]);
+            }
+            // A mapping of the rejected generation cannot be reused for the next one
+            if (counter_map_release(*counters))
+            {
+                *counters = init_counters(rank, *num_counters);
+            }
+        }
+        // The kept counters belong to the committed generation only
+        loaded = restart_generation(rank, paths[g], counters, *num_counters, first, keep_first, g == 0 ? keep_count : 0, cfg, &epoch);
+    }
+    if (!loaded)
+    {
+        if (rank == 0)
+        {
+            fprintf(stderr, "No valid checkpoint in %s or %s\n", paths[0], paths[1]);
+        }
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
+    ckpt_epoch = epoch;
 
-    char line[256];
-    int lines_to_skip = offset(rank, size, *num_counters);
+    // Bring the base up to date with the deltas written on top of it
+    if (cfg->ckpt_mode == CKPT_MODE_DELTA)
+    {
+        ckpt_epoch = delta_replay(rank, cfg, epoch, *counters, first, *num_counters);
+    }
+    trace_end(TRACE_RESTART_READ);
 
-    // Skip lines belonging to previous ranks in the file
-    for (int i = 0; i < lines_to_skip; i++)
+    // Counters now match what is on disk: nothing is dirty
+    if (cfg->ckpt_mode == CKPT_MODE_DELTA)
     {
-        if (!fgets(line, sizeof(line), f))
+        delta_track_reset(*num_counters);
+    }
+
+    // Only the counters still below the maximum take part in the next iterations
+    active_set_build(active, *counters, *num_counters, cfg->max_counter_value);
+
+    // Replicas of the old layout are useless from here on
+    buddy_mirror(comm, rank, size, *counters, *num_counters, cfg);
+    trace_end(TRACE_RESTART);
+    bench_end(BENCH_RESTART, comm);
+    metrics_end(METRICS_RESTART);
+}
+
+void checkpoint(int rank, int size, counter_t *counters, int64_t num_counters, const Config *cfg)
+{
+    printf("Rank %d checkpointed. Saving data...\n", rank);
+    trace_set_context(rank, size);
+
+    // From here on the counters in memory are the checkpoint, until the next restart()
+    held.valid = 1;
+    held.rank = rank;
+    held.size = size;
+    trace_begin(TRACE_CHECKPOINT);
+    bench_begin(BENCH_CHECKPOINT);
+    metrics_begin(METRICS_CHECKPOINT);
+    topology_record(buddy_world_comm());
+
+    // Fence: a periodic checkpoint still in flight must not race with this one
+    trace_begin(TRACE_CKPT_FENCE);
+    checkpoint_async_wait();
+    trace_end(TRACE_CKPT_FENCE);
+
+    // The work-stealing windows live on the communicator about to be replaced
+    work_steal_release();
+
+    if (cfg->ckpt_mode != CKPT_MODE_TEXT)
+    {
+        trace_begin(TRACE_CKPT_WRITE);
+        // Collective MPI-IO path: no per-rank files, no rank 0 aggregation
+        if (cfg->ckpt_mode == CKPT_MODE_MPIIO)
         {
-            fprintf(stderr, "Error skipping lines on rank %d\n", rank);
-            fclose(f);
+            checkpoint_mpiio(rank, size, counters, num_counters, cfg);
+        }
+        else if (cfg->ckpt_mode == CKPT_MODE_BINARY)
+        {
+            checkpoint_binary(rank, size, counters, num_counters, cfg);
+        }
+        else if (cfg->ckpt_mode == CKPT_MODE_DELTA)
+        {
+            checkpoint_delta(rank, size, counters, num_counters, cfg);
+        }
+        else if (cfg->ckpt_mode == CKPT_MODE_COMPRESSED)
+        {
+            checkpoint_compressed(rank, size, counters, num_counters, cfg);
+        }
+        // Two-level path: node-local files now, the global file in the background
+        else if (cfg->ckpt_mode == CKPT_MODE_NODE)
+        {
+            node_tier_checkpoint(rank, size, counters, num_counters, cfg);
+        }
+        // In-memory path: keep the counters for redistribution, the file is untouched
+        else if (cfg->ckpt_mode == CKPT_MODE_MEMORY)
+        {
+            redistribute_stash(rank, size, counters, num_counters, cfg);
+        }
+        trace_end(TRACE_CKPT_WRITE);
+        trace_end(TRACE_CHECKPOINT);
+        bench_end(BENCH_CHECKPOINT, buddy_world_comm());
+        metrics_end(METRICS_CHECKPOINT);
+
+        // A file was written: it protects this point as well as a periodic checkpoint would
+        if (cfg->ckpt_mode != CKPT_MODE_MEMORY)
+        {
+            checkpoint_schedule_reset();
+        }
+        return;
+    }
+
+    checkpoint_text(rank, size, counters, num_counters, cfg);
+    trace_end(TRACE_CHECKPOINT);
+    bench_end(BENCH_CHECKPOINT, buddy_world_comm());
+    metrics_end(METRICS_CHECKPOINT);
+    checkpoint_schedule_reset();
+}
+
+/**
+ * @brief Writes the pieces of one rank's text at their offsets of the staged file.
+ */
+static void write_stripe(MPI_File fh, MPI_Offset position, const char *text, int64_t bytes, int rank)
+{
+    for (int64_t done = 0; done < bytes; done += CKPT_TEXT_CHUNK)
+    {
+        int piece = (int)(bytes - done < CKPT_TEXT_CHUNK ? bytes - done : CKPT_TEXT_CHUNK);
+        if (MPI_File_write_at(fh, position + done, text + done, piece, MPI_CHAR, MPI_STATUS_IGNORE) != MPI_SUCCESS)
+        {
+            fprintf(stderr, "Write of the text checkpoint failed on rank %d\n", rank);
             MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
         }
     }
+}
+
+void checkpoint_text(int rank, int size, counter_t *counters, int64_t num_counters, const Config *cfg)
+{
+    MPI_Comm comm = buddy_world_comm();
+
+    // Phase 1: every rank formats its slice, one counter per line
+    trace_begin(TRACE_CKPT_WRITE);
+    char *text = arena_acquire((size_t)num_counters * CKPT_RECORD_WIDTH + 1);
+    int64_t bytes = 0;
+    for (int64_t i = 0; i < num_counters; i++)
+    {
+        bytes += snprintf(text + bytes, CKPT_RECORD_WIDTH + 1, "%d\n", counters[i]);
+    }
+    trace_end(TRACE_CKPT_WRITE);
 
-    // Read and validate local counter values
-    for (int i = 0; i < *num_counters; i++)
+    // The slices follow each other in block order, so the byte offsets are a scan in that order
+    trace_begin(TRACE_CKPT_BARRIER1);
+    MPI_Comm ordered;
+    MPI_Comm_split(comm, 0, slice_block(rank, size, cfg->num_counters), &ordered);
+    int64_t position = 0;
+    MPI_Exscan(&bytes, &position, 1, MPI_INT64_T, MPI_SUM, ordered);
+    int ordered_rank;
+    MPI_Comm_rank(ordered, &ordered_rank);
+    if (ordered_rank == 0)
     {
-        if (!fgets(line, sizeof(line), f))
+        position = 0;  // MPI_Exscan leaves the first rank's result undefined
+    }
+    MPI_Comm_free(&ordered);
+
+    MPI_Comm node, leaders;
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node);
+    int node_rank, node_size;
+    MPI_Comm_rank(node, &node_rank);
+    MPI_Comm_size(node, &node_size);
+    MPI_Comm_split(comm, node_rank == 0 ? 0 : MPI_UNDEFINED, rank, &leaders);
+    trace_end(TRACE_CKPT_BARRIER1);
+
+    // Phase 2: the members hand their text to the node leader, which writes the node's stripes
+    trace_begin(TRACE_CKPT_MERGE);
+    if (node_rank != 0)
+    {
+        int64_t extent[2] = {position, bytes};
+        MPI_Send(extent, 2, MPI_INT64_T, 0, 0, node);
+        for (int64_t done = 0; done < bytes; done += CKPT_TEXT_CHUNK)
         {
-            fprintf(stderr, "Failed to read counter line on rank %d\n", rank);
-            fclose(f);
+            int piece = (int)(bytes - done < CKPT_TEXT_CHUNK ? bytes - done : CKPT_TEXT_CHUNK);
+            MPI_Send(text + done, piece, MPI_CHAR, 0, 1, node);
+        }
+    }
+    else
+    {
+        int num_leaders;
+        MPI_Comm_size(leaders, &num_leaders);
+        char nodes[16];
+        snprintf(nodes, sizeof(nodes), "%d", num_leaders);
+        MPI_Info info;
+        MPI_Info_create(&info);
+        MPI_Info_set(info, "cb_nodes", nodes);
+
+        char staged[CKPT_PATH_SIZE];
+        checkpoint_staged_path(staged, sizeof(staged), cfg);
+        MPI_File fh;
+        if (MPI_File_open(leaders, staged, MPI_MODE_CREATE | MPI_MODE_WRONLY, info, &fh) != MPI_SUCCESS)
+        {
+            fprintf(stderr, "Could not open file %s with MPI-IO on rank %d\n", staged, rank);
             MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
         }
-        (*counters)[i] = atoi(line);
-        
-        // Validate counter values are within acceptable range
-        if ((*counters)[i] < 0 || (*counters)[i] > MAX_COUNTER_VALUE)
+        MPI_Info_free(&info);
+
+        int64_t node_bytes = bytes, total_bytes = 0;
+        write_stripe(fh, position, text, bytes, rank);
+
+        char *piece = node_size > 1 ? arena_acquire(CKPT_TEXT_CHUNK) : NULL;
+        for (int m = 1; m < node_size; m++)
+        {
+            int64_t extent[2];
+            MPI_Recv(extent, 2, MPI_INT64_T, m, 0, node, MPI_STATUS_IGNORE);
+            for (int64_t done = 0; done < extent[1]; done += CKPT_TEXT_CHUNK)
+            {
+                int count = (int)(extent[1] - done < CKPT_TEXT_CHUNK ? extent[1] - done : CKPT_TEXT_CHUNK);
+                MPI_Recv(piece, count, MPI_CHAR, m, 1, node, MPI_STATUS_IGNORE);
+                write_stripe(fh, extent[0] + done, piece, count, rank);
+            }
+            node_bytes += extent[1];
+        }
+        if (piece)
         {
-            fprintf(stderr, "Warning: Invalid counter value %d on rank %d, resetting to 0\n", (*counters)[i], rank);
-            (*counters)[i] = 0;
+            arena_release(piece);
         }
+
+        // Drop any trailing bytes left by an interrupted, longer checkpoint
+        MPI_Allreduce(&node_bytes, &total_bytes, 1, MPI_INT64_T, MPI_SUM, leaders);
+        MPI_File_set_size(fh, (MPI_Offset)total_bytes);
+        MPI_File_sync(fh);
+        MPI_File_close(&fh);
+        MPI_Comm_free(&leaders);
     }
-    fclose(f);
+    MPI_Comm_free(&node);
+    arena_release(text);
+    trace_end(TRACE_CKPT_MERGE);
+
+    // Final synchronization: the global checkpoint is complete before it is committed
+    trace_begin(TRACE_CKPT_BARRIER2);
+    checkpoint_commit(comm, rank, cfg);
+    trace_end(TRACE_CKPT_BARRIER2);
 }
 
-void checkpoint(int rank, int size, int *counters, int num_counters, char *filepath)
+void checkpoint_mpiio(int rank, int size, counter_t *counters, int64_t num_counters, const Config *cfg)
 {
-    printf("Rank %d checkpointed. Saving data...\n", rank);
+    MPI_Comm comm = buddy_world_comm();
 
-    // Phase 1: Each rank saves its local counters to a rank-specific file
-    char rank_filepath[512];  // Increased buffer size for safety
-    snprintf(rank_filepath, sizeof(rank_filepath), "%s.%03d", filepath, rank);
+    // Format the local slice as fixed-width records (one extra byte for the final NUL)
+    char *buffer = arena_acquire((size_t)num_counters * CKPT_RECORD_WIDTH + 1);
+    for (int64_t i = 0; i < num_counters; i++)
+    {
+        snprintf(buffer + (size_t)i * CKPT_RECORD_WIDTH, CKPT_RECORD_WIDTH + 1, "%*d\n", CKPT_RECORD_WIDTH - 1, counters[i]);
+    }
+
+    // One record is the elementary unit of the file view, so offsets are counter indices
+    MPI_Datatype record;
+    MPI_Type_contiguous(CKPT_RECORD_WIDTH, MPI_CHAR, &record);
+    MPI_Type_commit(&record);
 
-    FILE *f = fopen(rank_filepath, "w");
-    if (!f)
+    char staged[CKPT_PATH_SIZE];
+    checkpoint_staged_path(staged, sizeof(staged), cfg);
+    MPI_File fh;
+    if (MPI_File_open(comm, staged, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS)
     {
-        fprintf(stderr, "Could not open file %s on rank %d\n", rank_filepath, rank);
+        fprintf(stderr, "Could not open file %s with MPI-IO on rank %d\n", staged, rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
 
-    // Write local counters to rank-specific file (one per line)
-    for (int i = 0; i < num_counters; i++)
+    // Drop any trailing bytes left by an interrupted, longer checkpoint
+    MPI_File_set_size(fh, (MPI_Offset)cfg->num_counters * CKPT_RECORD_WIDTH);
+    MPI_File_set_view(fh, 0, record, record, "native", MPI_INFO_NULL);
+
+    // Each rank writes its slice at its global offset in a single collective call
+    if (MPI_File_write_at_all(fh, offset(rank, size, cfg->num_counters), buffer, (int)num_counters, record, MPI_STATUS_IGNORE) != MPI_SUCCESS)
     {
-        fprintf(f, "%d\n", counters[i]);  // Direct output - more efficient than sprintf+fputs
+        fprintf(stderr, "Collective write to %s failed on rank %d\n", staged, rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
 
-    fclose(f);
+    MPI_File_sync(fh);
+    MPI_File_close(&fh);
+    MPI_Type_free(&record);
+    arena_release(buffer);
+    checkpoint_commit(comm, rank, cfg);
+}
+
+void checkpoint_binary(int rank, int size, counter_t *counters, int64_t num_counters, const Config *cfg)
+{
+    MPI_Comm comm = buddy_world_comm();
+    int64_t first = offset(rank, size, cfg->num_counters);
 
-    MPI_Comm comm = dmr_get_world_comm();
+    // Partial checksums of disjoint slices add up to the global checksum
+    uint64_t local_sum = counter_checksum(counters, first, num_counters);
+    uint64_t global_sum = 0;
+    MPI_Reduce(&local_sum, &global_sum, 1, MPI_UINT64_T, MPI_SUM, 0, comm);
 
-    // Synchronization barrier: ensure all ranks complete Phase 1 before Phase 2
-    MPI_Barrier(comm);
+    // One CRC32C per block of the slice, written after the counter array
+    uint64_t num_crcs = ckpt_crc_count(num_counters);
+    uint32_t *crcs = malloc((num_crcs > 0 ? num_crcs : 1) * sizeof(uint32_t));
+    if (!crcs)
+    {
+        fprintf(stderr, "Memory allocation failed on rank %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    const int32_t *values = counter_view(counters, num_counters);
+    ckpt_crc_slice(values, num_counters, crcs);
 
-    // Phase 2: Rank 0 aggregates all rank-specific files into global checkpoint
+    char staged[CKPT_PATH_SIZE];
+    checkpoint_staged_path(staged, sizeof(staged), cfg);
+    MPI_File fh;
+    if (MPI_File_open(comm, staged, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+    {
+        fprintf(stderr, "Could not open file %s with MPI-IO on rank %d\n", staged, rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    MPI_File_set_size(fh, ckpt_crc_position(cfg->num_counters, size, size));
+
+    uint64_t epoch = checkpoint_next_epoch();
     if (rank == 0)
     {
-        f = fopen(filepath, "w");
-        if (!f)
+        CheckpointHeader header;
+        ckpt_header_init(&header, cfg->num_counters, size, epoch, global_sum);
+        if (MPI_File_write_at(fh, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE) != MPI_SUCCESS)
         {
-            fprintf(stderr, "Could not open file %s for writing on rank %d\n", filepath, rank);
+            fprintf(stderr, "Failed to write checkpoint header to %s\n", staged);
             MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
         }
+    }
 
-        // Aggregate counter data from all ranks in order
-        for (int r = 0; r < size; r++)
-        {
-            char other_filepath[512];  // Increased buffer size for consistency
-            snprintf(other_filepath, sizeof(other_filepath), "%s.%03d", filepath, r);
-            FILE *other_f = fopen(other_filepath, "r");
-            if (!other_f)
-            {
-                fprintf(stderr, "Could not open file %s for reading on rank %d\n", other_filepath, rank);
-                fclose(f);
-                MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
-            }
+    // Each rank writes its packed slice right after the header at its global offset, and its CRCs in the table
+    // at the place of its block
+    int block = slice_block(rank, size, cfg->num_counters);
+    MPI_Offset position = CKPT_HEADER_SIZE + (MPI_Offset)first * sizeof(int32_t);
+    if (MPI_File_write_at_all(fh, position, values, (int)num_counters, MPI_INT32_T, MPI_STATUS_IGNORE) != MPI_SUCCESS ||
+        MPI_File_write_at_all(fh, ckpt_crc_position(cfg->num_counters, size, block), crcs, (int)num_crcs, MPI_UINT32_T,
+                              MPI_STATUS_IGNORE) != MPI_SUCCESS)
+    {
+        fprintf(stderr, "Collective write to %s failed on rank %d\n", staged, rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
 
-            // Copy all lines from rank-specific file to global file
-            char line[256];
-            while (fgets(line, sizeof(line), other_f))
-            {
-                fputs(line, f);
-            }
-            fclose(other_f);
-        }
-        fclose(f);
+    MPI_File_sync(fh);
+    MPI_File_close(&fh);
+    free(crcs);
+    counter_view_release(values, counters);
+    checkpoint_commit(comm, rank, cfg);
+}
+
+void recover(int rank, counter_t **counters, int64_t *num_counters, ActiveSet *active, const Config *cfg)
+{
+    double start = MPI_Wtime();
+    checkpoint_async_abandon();
+
+    int old_size;
+    MPI_Comm comm = buddy_shrink(&old_size);
+    int new_rank, new_size;
+    MPI_Comm_rank(comm, &new_rank);
+    MPI_Comm_size(comm, &new_size);
+    trace_set_context(new_rank, new_size);
+
+    // The survivors take plain blocks: the mapping of a layout of this size belongs to an older epoch
+    partition_remap(new_size, cfg->num_counters, NULL);
+    int64_t count = dimension(new_rank, new_size, cfg->num_counters);
+    counter_t *rebuilt = init_counters(new_rank, count);
+    int64_t from_replicas = buddy_rebuild(comm, rank, old_size, *counters, rebuilt, cfg);
+    release_counters(*counters);
+    *counters = rebuilt;
+    *num_counters = count;
+
+    active_set_build(active, rebuilt, count, cfg->max_counter_value);
+    if (cfg->ckpt_mode == CKPT_MODE_DELTA)
+    {
+        // Counters moved between ranks: the next delta holds all of them
+        delta_track_reset(count);
+        delta_mark_all();
+    }
+    buddy_mirror(comm, new_rank, new_size, rebuilt, count, cfg);
+
+    if (new_rank == 0)
+    {
+        printf("Recovered from the failure of %d rank(s) in %.3f s: %d ranks left, %.1f MB rebuilt from buddy replicas\n",
+               old_size - new_size, MPI_Wtime() - start, new_size,
+               (double)from_replicas * sizeof(counter_t) / (1 << 20));
     }
+}
+
+uint64_t checkpoint_next_epoch(void)
+{
+    return ++ckpt_epoch;
+}
 
-    // Final synchronization: ensure global checkpoint is complete before proceeding
-    MPI_Barrier(comm);
+uint64_t checkpoint_epoch(void)
+{
+    return ckpt_epoch;
 }
 
-void finalize(int rank, int *counters)
+MPI_Datatype checkpoint_byte_type(uint64_t bytes)
+{
+    MPI_Datatype chunk, type;
+    MPI_Type_contiguous(CKPT_IO_CHUNK, MPI_BYTE, &chunk);
+
+    // Whole chunks first, then the tail; either block may be empty
+    int lengths[2] = {(int)(bytes / CKPT_IO_CHUNK), (int)(bytes % CKPT_IO_CHUNK)};
+    MPI_Aint displacements[2] = {0, (MPI_Aint)(bytes - bytes % CKPT_IO_CHUNK)};
+    MPI_Datatype types[2] = {chunk, MPI_BYTE};
+    MPI_Type_create_struct(2, lengths, displacements, types, &type);
+    MPI_Type_commit(&type);
+    MPI_Type_free(&chunk);
+    return type;
+}
+
+
+void finalize(int rank, counter_t *counters)
 {
     printf("Rank %d is about to exit. Freeing memory...\n", rank);
 
     // Safe memory deallocation with null pointer check
     if (counters)
     {
-        free(counters);
+        release_counters(counters);
     }
     else
     {
         fprintf(stderr, "Warning: Attempted to free NULL pointer on rank %d\n", rank);
     }
+
+    compute_kernel_release();
+
+    // A drain this rank leads must reach the global file before the process exits
+    node_tier_drain_wait();
+
+    // Leaving ranks write their events and logs too
+    trace_close();
+    status_close();
+    topology_release();
+    partition_release();
+    arena_close();
 }
 
-void compute()
+void compute(const Config *cfg)
 {
-    // Simulate computational work by sleeping for the defined time period
-    sleep(COMPUTE_TIME);
+    // Run the configured workload (sleep, STREAM triad or FMA chains)
+    compute_kernel_run(cfg);
 }
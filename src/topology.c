@@ -0,0 +1,389 @@
+/**
+ * @file topology.c
+ * @brief Implementation of the node-aware slice mapping.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "topology.h"
+#include "counter.h"
+#include "partition.h"
+#include "metrics.h"
+
+/** @brief Layout of the last checkpoint: its size and the node of every rank */
+static struct
+{
+    int size;
+    uint32_t *nodes;
+} recorded;
+
+/** @brief Overlap of a new block with the counters held by a node (or a rank) */
+typedef struct
+{
+    int64_t counters;
+    int block;
+    int holder;
+} Overlap;
+
+/**
+ * @brief Allocates or aborts.
+ */
+static void *checked_malloc(size_t bytes)
+{
+    void *p = malloc(bytes > 0 ? bytes : 1);
+    if (!p)
+    {
+        fprintf(stderr, "Memory allocation failed for the rank mapping\n");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    return p;
+}
+
+/**
+ * @brief Returns the node of the calling process: a hash of its processor name.
+ */
+static uint32_t node_id(void)
+{
+    char name[MPI_MAX_PROCESSOR_NAME];
+    int length = 0;
+    MPI_Get_processor_name(name, &length);
+
+    // FNV-1a, as for the node tier directories
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < length; i++)
+    {
+        hash = (hash ^ (unsigned char)name[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Orders node ids, for the sorted list of distinct nodes.
+ */
+static int compare_nodes(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * @brief Orders overlaps by decreasing size, then block and holder, so every process gets the same order.
+ */
+static int compare_overlaps(const void *a, const void *b)
+{
+    const Overlap *x = a, *y = b;
+    if (x->counters != y->counters)
+    {
+        return x->counters > y->counters ? -1 : 1;
+    }
+    if (x->block != y->block)
+    {
+        return x->block < y->block ? -1 : 1;
+    }
+    return x->holder < y->holder ? -1 : x->holder > y->holder;
+}
+
+/**
+ * @brief Returns the index of a node in the sorted distinct nodes, -1 if it is not there.
+ */
+static int node_index(const uint32_t *ids, int count, uint32_t node)
+{
+    const uint32_t *found = bsearch(&node, ids, count, sizeof(uint32_t), compare_nodes);
+    return found ? (int)(found - ids) : -1;
+}
+
+/**
+ * @brief Counters shared by block j of the new layout and block b of the old one.
+ */
+static int64_t shared(const Partition *old_layout, int b, const Partition *new_layout, int j)
+{
+    int64_t lo = old_layout->starts[b] > new_layout->starts[j] ? old_layout->starts[b] : new_layout->starts[j];
+    int64_t hi = old_layout->starts[b + 1] < new_layout->starts[j + 1] ? old_layout->starts[b + 1] : new_layout->starts[j + 1];
+    return hi > lo ? hi - lo : 0;
+}
+
+/**
+ * @brief Returns the old blocks overlapping block j of the new layout, none if it is empty.
+ */
+static void overlap(const Partition *old_layout, const Partition *layout, int j, int *lo, int *hi)
+{
+    int64_t count = layout->starts[j + 1] - layout->starts[j];
+    *lo = *hi = 0;
+    if (count > 0)
+    {
+        partition_overlap(old_layout, layout->starts[j], count, lo, hi);
+    }
+}
+
+/**
+ * @brief Maps the blocks of a layout of size ranks on nodes[] to keep the counters of the old layout local.
+ */
+static void plan(const Partition *old_layout, const uint32_t *old_nodes, int size, const uint32_t *nodes, int kept_ranks,
+                 int *block_of)
+{
+    const Partition *layout = partition_get(size, old_layout->total);
+
+    // Distinct nodes of the new layout, with the ranks each one has left to fill
+    uint32_t *ids = checked_malloc((size_t)size * sizeof(uint32_t));
+    memcpy(ids, nodes, (size_t)size * sizeof(uint32_t));
+    qsort(ids, size, sizeof(uint32_t), compare_nodes);
+    int num_nodes = 0;
+    for (int r = 0; r < size; r++)
+    {
+        if (num_nodes == 0 || ids[num_nodes - 1] != ids[r])
+        {
+            ids[num_nodes++] = ids[r];
+        }
+    }
+    int *free_ranks = checked_malloc((size_t)num_nodes * sizeof(int));
+    int *rank_node = checked_malloc((size_t)size * sizeof(int));
+    memset(free_ranks, 0, (size_t)num_nodes * sizeof(int));
+    for (int r = 0; r < size; r++)
+    {
+        rank_node[r] = node_index(ids, num_nodes, nodes[r]);
+        free_ranks[rank_node[r]]++;
+    }
+
+    // Overlaps of every new block with the nodes holding it, old blocks of one node merged
+    int64_t max_overlaps = 0;
+    for (int j = 0; j < size; j++)
+    {
+        int lo, hi;
+        overlap(old_layout, layout, j, &lo, &hi);
+        max_overlaps += hi - lo;
+    }
+    Overlap *overlaps = checked_malloc((size_t)max_overlaps * sizeof(Overlap));
+    int64_t count = 0;
+    for (int j = 0; j < size; j++)
+    {
+        int lo, hi;
+        int64_t first_of_block = count;
+        overlap(old_layout, layout, j, &lo, &hi);
+        for (int b = lo; b < hi; b++)
+        {
+            int h = node_index(ids, num_nodes, old_nodes[partition_rank(old_layout, b)]);
+            if (h < 0)
+            {
+                continue;
+            }
+            int64_t k = first_of_block;
+            while (k < count && overlaps[k].holder != h)
+            {
+                k++;
+            }
+            if (k == count)
+            {
+                overlaps[count++] = (Overlap){0, j, h};
+            }
+            overlaps[k].counters += shared(old_layout, b, layout, j);
+        }
+    }
+
+    // Pass 1: blocks to nodes, largest overlap first
+    int *block_node = checked_malloc((size_t)size * sizeof(int));
+    for (int j = 0; j < size; j++)
+    {
+        block_node[j] = -1;
+    }
+    qsort(overlaps, count, sizeof(Overlap), compare_overlaps);
+    for (int64_t k = 0; k < count; k++)
+    {
+        Overlap *o = &overlaps[k];
+        if (block_node[o->block] < 0 && free_ranks[o->holder] > 0)
+        {
+            block_node[o->block] = o->holder;
+            free_ranks[o->holder]--;
+        }
+    }
+    for (int j = 0, h = 0; j < size; j++)
+    {
+        while (block_node[j] < 0)
+        {
+            if (free_ranks[h] > 0)
+            {
+                block_node[j] = h;
+                free_ranks[h]--;
+            }
+            else
+            {
+                h++;
+            }
+        }
+    }
+
+    // Pass 2: within each node, blocks to the ranks that hold most of them already
+    int *rank_block = block_of;
+    int *block_rank = checked_malloc((size_t)size * sizeof(int));
+    for (int r = 0; r < size; r++)
+    {
+        rank_block[r] = -1;
+        block_rank[r] = -1;
+    }
+    count = 0;
+    for (int j = 0; kept_ranks && j < size; j++)
+    {
+        int lo, hi;
+        overlap(old_layout, layout, j, &lo, &hi);
+        for (int b = lo; b < hi; b++)
+        {
+            int r = partition_rank(old_layout, b);
+            if (r < size && rank_node[r] == block_node[j])
+            {
+                overlaps[count++] = (Overlap){shared(old_layout, b, layout, j), j, r};
+            }
+        }
+    }
+    qsort(overlaps, count, sizeof(Overlap), compare_overlaps);
+    for (int64_t k = 0; k < count; k++)
+    {
+        Overlap *o = &overlaps[k];
+        if (block_rank[o->block] < 0 && rank_block[o->holder] < 0)
+        {
+            block_rank[o->block] = o->holder;
+            rank_block[o->holder] = o->block;
+        }
+    }
+    for (int j = 0; j < size; j++)
+    {
+        for (int r = 0; block_rank[j] < 0 && r < size; r++)
+        {
+            if (rank_block[r] < 0 && rank_node[r] == block_node[j])
+            {
+                block_rank[j] = r;
+                rank_block[r] = j;
+            }
+        }
+    }
+
+    free(block_rank);
+    free(block_node);
+    free(overlaps);
+    free(rank_node);
+    free(free_ranks);
+    free(ids);
+}
+
+/**
+ * @brief Prints the bytes of the new slices kept in place, moved within nodes and moved across nodes.
+ *
+ * @return Bytes of the new slices that came from another rank
+ */
+static double report(const Partition *old_layout, const uint32_t *old_nodes, const Partition *layout, const uint32_t *nodes,
+                   int kept_ranks, const Config *cfg)
+{
+    double moved[3] = {0.0, 0.0, 0.0};
+    for (int r = 0; r < layout->size; r++)
+    {
+        int j = partition_block(layout, r);
+        int lo, hi;
+        overlap(old_layout, layout, j, &lo, &hi);
+        for (int b = lo; b < hi; b++)
+        {
+            int o = partition_rank(old_layout, b);
+            int where = kept_ranks && o == r ? 0 : old_nodes[o] == nodes[r] ? 1 : 2;
+            moved[where] += (double)shared(old_layout, b, layout, j) * sizeof(counter_t);
+        }
+    }
+    if (cfg->verbosity >= 1)
+    {
+        printf("Redistribution %d -> %d ranks (%s mapping): %.1f MB in place, %.1f MB within nodes, %.1f MB across nodes\n",
+               old_layout->size, layout->size, rank_mapping_name(cfg->mapping), moved[0] / (1 << 20),
+               moved[1] / (1 << 20), moved[2] / (1 << 20));
+    }
+    return moved[1] + moved[2];
+}
+
+void topology_record(MPI_Comm comm)
+{
+    int size;
+    MPI_Comm_size(comm, &size);
+    free(recorded.nodes);
+    recorded.nodes = checked_malloc((size_t)size * sizeof(uint32_t));
+    recorded.size = size;
+    uint32_t node = node_id();
+    MPI_Allgather(&node, 1, MPI_UINT32_T, recorded.nodes, 1, MPI_UINT32_T, comm);
+}
+
+void topology_prepare_shrink(int target, const Config *cfg)
+{
+    if (cfg->mapping != RANK_MAPPING_TOPOLOGY || target <= 0 || target >= recorded.size)
+    {
+        return;
+    }
+
+    // The survivors are the lowest ranks, on the nodes they were recorded on
+    int *block_of = checked_malloc((size_t)target * sizeof(int));
+    plan(partition_get(recorded.size, cfg->num_counters), recorded.nodes, target, recorded.nodes, 1, block_of);
+    partition_remap(target, cfg->num_counters, block_of);
+    free(block_of);
+}
+
+void topology_remap(MPI_Comm comm, int kept_ranks, const Config *cfg)
+{
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    // Rank 0 survived: it knows the old layout, its mapping and its nodes
+    int old_size = recorded.size;
+    MPI_Bcast(&old_size, 1, MPI_INT, 0, comm);
+    if (old_size <= 0)
+    {
+        return;
+    }
+    int *old_map = checked_malloc(2 * (size_t)old_size * sizeof(int));
+    if (rank == 0)
+    {
+        const Partition *old_layout = partition_get(old_size, cfg->num_counters);
+        for (int r = 0; r < old_size; r++)
+        {
+            old_map[r] = partition_block(old_layout, r);
+            old_map[old_size + r] = (int)recorded.nodes[r];
+        }
+    }
+    MPI_Bcast(old_map, 2 * old_size, MPI_INT, 0, comm);
+    if (recorded.size != old_size)
+    {
+        free(recorded.nodes);
+        recorded.nodes = checked_malloc((size_t)old_size * sizeof(uint32_t));
+        recorded.size = old_size;
+    }
+    for (int r = 0; r < old_size; r++)
+    {
+        recorded.nodes[r] = (uint32_t)old_map[old_size + r];
+    }
+    const Partition *old_layout = partition_remap(old_size, cfg->num_counters, old_map);
+
+    uint32_t *nodes = checked_malloc((size_t)size * sizeof(uint32_t));
+    uint32_t node = node_id();
+    MPI_Allgather(&node, 1, MPI_UINT32_T, nodes, 1, MPI_UINT32_T, comm);
+
+    // A layout of the same size keeps its mapping
+    if (cfg->mapping == RANK_MAPPING_TOPOLOGY && size != old_size)
+    {
+        int *block_of = checked_malloc((size_t)size * sizeof(int));
+        plan(old_layout, recorded.nodes, size, nodes, kept_ranks, block_of);
+        partition_remap(size, cfg->num_counters, block_of);
+        free(block_of);
+    }
+
+    if (rank == 0)
+    {
+        metrics_moved(report(old_layout, recorded.nodes, partition_get(size, cfg->num_counters), nodes, kept_ranks, cfg));
+    }
+    free(nodes);
+    free(old_map);
+}
+
+void topology_release(void)
+{
+    free(recorded.nodes);
+    recorded.nodes = NULL;
+    recorded.size = 0;
+}
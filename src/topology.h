@@ -0,0 +1,74 @@
+/**
+ * @file topology.h
+ * @brief Node-aware assignment of the counter slices to the ranks of a new layout.
+ *
+ * The counters are always split into the same contiguous blocks (partition.h),
+ * but which rank holds which block is up to the mapping. With the default
+ * --mapping=block, rank i holds block i, so after a resize most blocks change
+ * owner and, with ranks spread over nodes, most bytes cross the network.
+ *
+ * With --mapping=topology, restart() assigns the blocks of the new layout in
+ * two greedy passes over the overlap of every new block with the old ones:
+ * - blocks to nodes, largest overlap with the counters already on a node
+ *   first, as many blocks per node as it has ranks;
+ * - within a node, blocks to the ranks that already hold most of them, so
+ *   restart() keeps them in place.
+ *
+ * Nodes are told apart by a hash of MPI_Get_processor_name(), the host names
+ * SLURM lists, which stay the same across communicators; checkpoint() records
+ * the node of every rank of the old layout. Every process computes the same
+ * mapping from the same inputs, so no mapping is ever communicated except the
+ * old one, from rank 0 to spawned processes. For a shrink in CKPT_MODE_MEMORY,
+ * the survivors' mapping is already computed when the data is stashed.
+ *
+ * Rank 0 reports, for every reconfiguration, the bytes of the new slices that
+ * stay in place, move within a node and move across nodes.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <mpi.h>
+
+#include "config.h"
+
+/**
+ * @brief Records the node of every rank of the layout being checkpointed.
+ *
+ * @param comm Communicator of the layout
+ *
+ * @note Collective over comm
+ */
+void topology_record(MPI_Comm comm);
+
+/**
+ * @brief Installs the mapping of the survivors of a shrink of the recorded layout.
+ *
+ * @param target Number of ranks left, the lowest ranks of the recorded layout
+ * @param cfg Runtime configuration (mapping, num_counters)
+ *
+ * @note Local; every rank of the recorded layout computes the same mapping
+ */
+void topology_prepare_shrink(int target, const Config *cfg);
+
+/**
+ * @brief Installs the old layout and maps the blocks of the new one, then reports the bytes moved.
+ *
+ * @param comm Communicator of the new layout
+ * @param kept_ranks 1 if the survivors kept their rank numbers
+ * @param cfg Runtime configuration (mapping, num_counters, verbosity)
+ *
+ * @note Collective over comm, before any slice of the new layout is used
+ */
+void topology_remap(MPI_Comm comm, int kept_ranks, const Config *cfg);
+
+/**
+ * @brief Frees the recorded layout.
+ */
+void topology_release(void);
+
+#endif /* TOPOLOGY_H */
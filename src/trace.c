@@ -0,0 +1,215 @@
+/**
+ * @file trace.c
+ * @brief Implementation of the per-phase timing instrumentation.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "trace.h"
+
+/** @brief Events buffered in memory before a flush to the trace file */
+#define TRACE_CAPACITY 4096
+
+/** @brief Names of the phases, indexed by TracePhase */
+static const char *phase_names[TRACE_PHASE_COUNT] = {
+    [TRACE_DMR_INIT] = "dmr_init",
+    [TRACE_COMPUTE] = "compute",
+    [TRACE_RECONFIG] = "reconfig",
+    [TRACE_CHECKPOINT] = "checkpoint",
+    [TRACE_CKPT_FENCE] = "ckpt_fence",
+    [TRACE_CKPT_WRITE] = "ckpt_write",
+    [TRACE_CKPT_BARRIER1] = "ckpt_barrier1",
+    [TRACE_CKPT_MERGE] = "ckpt_merge",
+    [TRACE_CKPT_BARRIER2] = "ckpt_barrier2",
+    [TRACE_RESTART] = "restart",
+    [TRACE_RESTART_READ] = "restart_read",
+    [TRACE_ASYNC_BEGIN] = "async_begin",
+};
+
+/** @brief One completed phase */
+typedef struct
+{
+    uint64_t start_ns;
+    uint64_t duration_ns;
+    int rank;
+    int size;
+    TracePhase phase;
+} TraceEvent;
+
+/** @brief State of the tracer of this process */
+static struct
+{
+    int enabled;
+    TraceFormat format;
+    char path[sizeof(((Config *)0)->trace_path) + 16];
+    FILE *file;
+    int written;
+    int rank;
+    int size;
+    uint64_t started[TRACE_PHASE_COUNT];
+    double total[TRACE_PHASE_COUNT];
+    int count;
+    TraceEvent events[TRACE_CAPACITY];
+} tracer;
+
+/**
+ * @brief Reads the monotonic clock in nanoseconds.
+ */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Writes the buffered events to the trace file and empties the buffer.
+ */
+static void trace_flush(void)
+{
+    if (!tracer.file)
+    {
+        tracer.file = fopen(tracer.path, "w");
+        if (!tracer.file)
+        {
+            fprintf(stderr, "Warning: Could not open trace file %s, tracing disabled\n", tracer.path);
+            tracer.enabled = 0;
+            return;
+        }
+        if (tracer.format == TRACE_FORMAT_CHROME)
+        {
+            fputs("[\n", tracer.file);
+        }
+    }
+
+    for (int i = 0; i < tracer.count; i++)
+    {
+        const TraceEvent *e = &tracer.events[i];
+        if (tracer.format == TRACE_FORMAT_CHROME)
+        {
+            fprintf(tracer.file, "%s{\"name\":\"%s\",\"cat\":\"dmr\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"size\":%d}}",
+                    tracer.written ? ",\n" : "", phase_names[e->phase], e->start_ns / 1e3, e->duration_ns / 1e3,
+                    (int)getpid(), e->rank, e->size);
+        }
+        else
+        {
+            fprintf(tracer.file, "{\"phase\":\"%s\",\"rank\":%d,\"size\":%d,\"pid\":%d,\"start_us\":%.3f,\"dur_us\":%.3f}\n",
+                    phase_names[e->phase], e->rank, e->size, (int)getpid(), e->start_ns / 1e3, e->duration_ns / 1e3);
+        }
+        tracer.written++;
+    }
+    tracer.count = 0;
+}
+
+void trace_init(const Config *cfg)
+{
+    tracer.enabled = cfg->trace_path[0] != '\0';
+    tracer.format = cfg->trace_format;
+    snprintf(tracer.path, sizeof(tracer.path), "%s.%d", cfg->trace_path, (int)getpid());
+}
+
+void trace_set_context(int rank, int size)
+{
+    tracer.rank = rank;
+    tracer.size = size;
+}
+
+void trace_begin(TracePhase phase)
+{
+    if (tracer.enabled)
+    {
+        tracer.started[phase] = now_ns();
+    }
+}
+
+void trace_end(TracePhase phase)
+{
+    if (!tracer.enabled)
+    {
+        return;
+    }
+
+    uint64_t end = now_ns();
+    TraceEvent *e = &tracer.events[tracer.count++];
+    e->start_ns = tracer.started[phase];
+    e->duration_ns = end - tracer.started[phase];
+    e->rank = tracer.rank;
+    e->size = tracer.size;
+    e->phase = phase;
+    tracer.total[phase] += e->duration_ns * 1e-9;
+
+    if (tracer.count == TRACE_CAPACITY)
+    {
+        trace_flush();
+    }
+}
+
+void trace_summary(MPI_Comm comm)
+{
+    // Every rank of comm sees the same configuration, so they agree on skipping
+    if (!tracer.enabled)
+    {
+        return;
+    }
+
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    double min[TRACE_PHASE_COUNT], max[TRACE_PHASE_COUNT], sum[TRACE_PHASE_COUNT];
+    MPI_Reduce(tracer.total, min, TRACE_PHASE_COUNT, MPI_DOUBLE, MPI_MIN, 0, comm);
+    MPI_Reduce(tracer.total, max, TRACE_PHASE_COUNT, MPI_DOUBLE, MPI_MAX, 0, comm);
+    MPI_Reduce(tracer.total, sum, TRACE_PHASE_COUNT, MPI_DOUBLE, MPI_SUM, 0, comm);
+
+    if (rank == 0)
+    {
+        printf("Phase timings over %d ranks (seconds):\n", size);
+        printf("%-14s %12s %12s %12s %10s\n", "phase", "min", "max", "avg", "imbalance");
+        for (int p = 0; p < TRACE_PHASE_COUNT; p++)
+        {
+            if (max[p] <= 0.0)
+            {
+                continue;
+            }
+            double avg = sum[p] / size;
+            printf("%-14s %12.6f %12.6f %12.6f %9.2fx\n", phase_names[p], min[p], max[p], avg, max[p] / avg);
+        }
+    }
+}
+
+void trace_close(void)
+{
+    if (!tracer.enabled)
+    {
+        return;
+    }
+
+    trace_flush();
+    if (tracer.file)
+    {
+        if (tracer.format == TRACE_FORMAT_CHROME)
+        {
+            fputs("\n]\n", tracer.file);
+        }
+        fclose(tracer.file);
+        tracer.file = NULL;
+    }
+    tracer.enabled = 0;
+}
+
+const char *trace_phase_name(TracePhase phase)
+{
+    if ((unsigned)phase >= TRACE_PHASE_COUNT)
+    {
+        return "unknown";
+    }
+    return phase_names[phase];
+}
@@ -0,0 +1,105 @@
+/**
+ * @file trace.h
+ * @brief Lightweight per-phase timing instrumentation.
+ *
+ * trace_begin()/trace_end() pairs measure the duration of a phase with the
+ * monotonic clock. Every completed phase is appended to a fixed-size per-process
+ * buffer, which is flushed to "<trace>.<pid>" whenever it fills up and when the
+ * process terminates, either as JSON lines or in the Chrome trace event format
+ * (load the file in chrome://tracing or Perfetto). trace_summary() reduces the
+ * time spent per phase across ranks to expose imbalance.
+ *
+ * With no trace file configured every call returns right away, so the
+ * instrumentation can stay in place in production runs.
+ *
+ * @note Timestamps come from CLOCK_MONOTONIC and are only comparable between
+ *       processes on the same node
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <mpi.h>
+
+#include "config.h"
+
+/**
+ * @brief Phases that can be timed.
+ */
+typedef enum
+{
+    TRACE_DMR_INIT = 0,  /**< DMR_AUTO around dmr_init(), including restart() of spawned ranks */
+    TRACE_COMPUTE,       /**< Increment and compute loop of one iteration */
+    TRACE_RECONFIG,      /**< DMR_AUTO around dmr_check(): checkpoint, spawn/shrink and restart */
+    TRACE_CHECKPOINT,    /**< Whole checkpoint() callback */
+    TRACE_CKPT_FENCE,    /**< Wait for the asynchronous checkpoint in flight */
+    TRACE_CKPT_WRITE,    /**< Local write: text formatting (phase 1) or the collective/in-memory path */
+    TRACE_CKPT_BARRIER1, /**< Offsets of the text slices and node communicators */
+    TRACE_CKPT_MERGE,    /**< Node leaders gathering and writing the text of their node */
+    TRACE_CKPT_BARRIER2, /**< Commit of the text checkpoint */
+    TRACE_RESTART,       /**< Whole restart() callback */
+    TRACE_RESTART_READ,  /**< Reading (and parsing) the checkpoint or the in-memory stash */
+    TRACE_ASYNC_BEGIN,   /**< Snapshot and start of an asynchronous checkpoint */
+    TRACE_PHASE_COUNT
+} TracePhase;
+
+/**
+ * @brief Enables tracing if a trace file is configured.
+ *
+ * @param cfg Runtime configuration (trace_path, trace_format)
+ */
+void trace_init(const Config *cfg);
+
+/**
+ * @brief Records the rank and communicator size attached to the following events.
+ *
+ * @param rank Current MPI rank
+ * @param size Total number of MPI ranks
+ */
+void trace_set_context(int rank, int size);
+
+/**
+ * @brief Starts timing a phase.
+ *
+ * @param phase Phase to time; phases are not reentrant
+ */
+void trace_begin(TracePhase phase);
+
+/**
+ * @brief Stops timing a phase and records the event.
+ *
+ * @param phase Phase started by trace_begin()
+ */
+void trace_end(TracePhase phase);
+
+/**
+ * @brief Prints min/max/avg time per phase across ranks on rank 0.
+ *
+ * Times are the totals accumulated by each process since it started.
+ *
+ * @param comm Communicator over which the totals are reduced
+ *
+ * @note Collective over comm; a no-op when tracing is disabled
+ */
+void trace_summary(MPI_Comm comm);
+
+/**
+ * @brief Flushes the remaining events and closes the trace file.
+ *
+ * @note Called once per process, before it exits
+ */
+void trace_close(void);
+
+/**
+ * @brief Returns the name of a phase, as written in the trace.
+ *
+ * @param phase Traced phase
+ * @return Phase name
+ */
+const char *trace_phase_name(TracePhase phase);
+
+#endif /* TRACE_H */
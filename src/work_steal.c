@@ -0,0 +1,185 @@
+/**
+ * @file work_steal.c
+ * @brief Implementation of the RMA work-stealing iteration.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#include "test.h"
+#include "work_steal.h"
+#include "delta_checkpoint.h"
+#include "hybrid.h"
+
+/** @brief Windows of the current configuration and the buffers they expose */
+static struct
+{
+    int valid;
+    MPI_Comm comm;
+    MPI_Win cursor_win;
+    int64_t *cursor;
+    MPI_Win work_win;
+    counter_t *work;
+    int64_t capacity;
+    counter_t *chunk;
+    int64_t *live;
+    int64_t taken;
+} steal = {0};
+
+/**
+ * @brief Creates the cursor and work windows on comm, sized for num_counters.
+ */
+static void steal_prepare(MPI_Comm comm, int64_t num_counters, const Config *cfg)
+{
+    if (steal.valid)
+    {
+        if (steal.comm != comm || num_counters > steal.capacity)
+        {
+            fprintf(stderr, "Work-stealing windows were not released before a reconfiguration\n");
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        return;
+    }
+
+    int size;
+    MPI_Comm_size(comm, &size);
+
+    MPI_Win_allocate(sizeof(int64_t), sizeof(int64_t), MPI_INFO_NULL, comm, &steal.cursor, &steal.cursor_win);
+    *steal.cursor = 0;
+
+    steal.capacity = num_counters;
+    steal.work = malloc((num_counters > 0 ? num_counters : 1) * sizeof(counter_t));
+    steal.chunk = malloc(cfg->steal_chunk * sizeof(counter_t));
+    steal.live = malloc(size * sizeof(int64_t));
+    if (!steal.work || !steal.chunk || !steal.live)
+    {
+        fprintf(stderr, "Memory allocation failed for work-stealing buffers\n");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    MPI_Win_create(steal.work, num_counters * sizeof(counter_t), sizeof(counter_t), MPI_INFO_NULL, comm, &steal.work_win);
+
+    // One passive-target epoch for the whole configuration
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, steal.cursor_win);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, steal.work_win);
+    steal.comm = comm;
+    steal.valid = 1;
+}
+
+/**
+ * @brief Increments and computes a run of live counter values, on the thread team of the rank.
+ */
+static void run_chunk(counter_t *values, int64_t length, const Config *cfg)
+{
+#pragma omp parallel for num_threads(hybrid_threads()) schedule(static)
+    for (int64_t k = 0; k < length; k++)
+    {
+        values[k]++;
+        compute(cfg);
+    }
+}
+
+/**
+ * @brief Claims the next chunk of a rank, returning its index or -1 when none is left.
+ */
+static int64_t claim(int target, int64_t chunk_size)
+{
+    const int64_t one = 1;
+    int64_t index;
+    MPI_Fetch_and_op(&one, &index, MPI_INT64_T, target, 0, MPI_SUM, steal.cursor_win);
+    MPI_Win_flush(target, steal.cursor_win);
+    return index * chunk_size < steal.live[target] ? index : -1;
+}
+
+void work_steal_iteration(MPI_Comm comm, counter_t *counters, int64_t num_counters, ActiveSet *active, const Config *cfg)
+{
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    steal_prepare(comm, num_counters, cfg);
+
+    // Publish this iteration's work: packed live values and a fresh chunk cursor
+    for (int64_t k = 0; k < active->count; k++)
+    {
+        steal.work[k] = counters[active->live[k]];
+    }
+    const int64_t zero = 0;
+    int64_t previous;
+    MPI_Fetch_and_op(&zero, &previous, MPI_INT64_T, rank, 0, MPI_REPLACE, steal.cursor_win);
+    MPI_Win_flush(rank, steal.cursor_win);
+    MPI_Win_sync(steal.work_win);
+
+    // Doubles as the barrier that makes every cursor reset visible before any claim
+    MPI_Allgather(&active->count, 1, MPI_INT64_T, steal.live, 1, MPI_INT64_T, comm);
+
+    // Own chunks first, then the other ranks in round-robin order
+    for (int step = 0; step < size; step++)
+    {
+        int victim = (rank + step) % size;
+        int64_t index;
+        while ((index = claim(victim, cfg->steal_chunk)) >= 0)
+        {
+            // The last chunk of a rank may be partial
+            int64_t first = index * cfg->steal_chunk;
+            int64_t length = steal.live[victim] - first < cfg->steal_chunk ? steal.live[victim] - first : cfg->steal_chunk;
+            if (victim == rank)
+            {
+                run_chunk(steal.work + first, length, cfg);
+                continue;
+            }
+
+            MPI_Get(steal.chunk, (int)length, MPI_COUNTER, victim, first, (int)length, MPI_COUNTER, steal.work_win);
+            MPI_Win_flush(victim, steal.work_win);
+            run_chunk(steal.chunk, length, cfg);
+            MPI_Put(steal.chunk, (int)length, MPI_COUNTER, victim, first, (int)length, MPI_COUNTER, steal.work_win);
+            MPI_Win_flush(victim, steal.work_win);
+            steal.taken++;
+        }
+    }
+
+    // Every stolen chunk is back home once all ranks are past this point
+    MPI_Barrier(comm);
+    MPI_Win_sync(steal.work_win);
+
+    // Copy the results into the slice and drop the counters that finished
+    int64_t kept = 0;
+    for (int64_t k = 0; k < active->count; k++)
+    {
+        int i = active->live[k];
+        counters[i] = steal.work[k];
+        delta_mark_dirty(i);
+        if (counters[i] < cfg->max_counter_value)
+        {
+            active->live[kept++] = i;
+        }
+    }
+    active->count = kept;
+}
+
+int64_t work_steal_taken(void)
+{
+    int64_t taken = steal.taken;
+    steal.taken = 0;
+    return taken;
+}
+
+void work_steal_release(void)
+{
+    if (!steal.valid)
+    {
+        return;
+    }
+
+    MPI_Win_unlock_all(steal.work_win);
+    MPI_Win_unlock_all(steal.cursor_win);
+    MPI_Win_free(&steal.work_win);
+    MPI_Win_free(&steal.cursor_win);
+    free(steal.work);
+    free(steal.chunk);
+    free(steal.live);
+    steal.work = NULL;
+    steal.chunk = NULL;
+    steal.live = NULL;
+    steal.capacity = 0;
+    steal.valid = 0;
+}
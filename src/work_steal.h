@@ -0,0 +1,66 @@
+/**
+ * @file work_steal.h
+ * @brief Dynamic load balancing of one iteration through one-sided MPI RMA.
+ *
+ * At the start of an iteration every rank packs the values of its live counters
+ * into a work buffer exposed in an RMA window and splits it into chunks of
+ * steal_chunk counters. A chunk cursor per rank, in a second window, is advanced
+ * with MPI_Fetch_and_op, so each chunk is claimed by exactly one process: first
+ * the owner works through its own chunks, then it steals from the other ranks by
+ * fetching a chunk, computing it and putting the values back.
+ *
+ * Counters never change owner: stolen chunks are written back into the owner's
+ * work buffer before the iteration ends, and the owner copies them into its slice.
+ * checkpoint() therefore still writes every counter exactly once, from the rank
+ * given by offset()/dimension().
+ *
+ * The windows are created lazily on the current communicator and must be released
+ * with work_steal_release() by all its ranks before it changes.
+ *
+ * @author Marco De Rosso
+ * @date 14/10/2026
+ * @version 1.0
+ */
+
+#ifndef WORK_STEAL_H
+#define WORK_STEAL_H
+
+#include <mpi.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "active_set.h"
+#include "counter.h"
+
+/**
+ * @brief Runs one iteration over the live counters of every rank with work stealing.
+ *
+ * Every live counter is incremented once and compute() is called for it, as in
+ * the static loop, but chunks may run on another rank. Finished counters are
+ * dropped from the active set afterwards.
+ *
+ * @param comm Communicator of the current configuration
+ * @param counters Pointer to the local counters array
+ * @param num_counters Number of counters in the local array
+ * @param active Active set of the local counters
+ * @param cfg Runtime configuration (steal_chunk, max_counter_value, compute kernel)
+ *
+ * @note Collective over comm
+ */
+void work_steal_iteration(MPI_Comm comm, counter_t *counters, int64_t num_counters, ActiveSet *active, const Config *cfg);
+
+/**
+ * @brief Returns the number of chunks this process stole since the previous call.
+ *
+ * @return Chunks computed on behalf of other ranks
+ */
+int64_t work_steal_taken(void);
+
+/**
+ * @brief Frees the RMA windows, if any.
+ *
+ * @note Collective over the communicator the windows were created on
+ */
+void work_steal_release(void);
+
+#endif /* WORK_STEAL_H */